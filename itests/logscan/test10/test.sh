@@ -0,0 +1,59 @@
+#!/bin/sh
+
+set -eu
+
+BIN=../../../src/logscan/ctguard-logscan
+if ! [ -e ${BIN} ]; then
+    echo "Could not find binary at '${BIN}'!"
+    exit 1
+fi
+
+cleanup () {
+    rm -f test.log test.output test.output.running test.state
+}
+
+cleanup
+
+chmod 640 test.conf
+touch test.log test.state
+
+${BIN} --cfg-file test.conf --unittest -f &
+pid=$!
+echo "Daemon running with pid ${pid}."
+
+trap "kill -9 ${pid}" 0 2
+
+sleep 0.5
+
+printf 'sshd: connection closed\nsshd: connection closed\nsshd: connection opened\nsshd: connection closed\n' >> test.log
+
+sleep 0.5
+
+printf 'sshd: connection closed\nsshd: single\n' >> test.log
+
+# the summary is passed on at the end of the window, long before the check interval
+sleep 3
+
+printf 'sshd: connection closed\n' >> test.log
+
+sleep 1
+
+cp test.output test.output.running
+
+if ! ps -p ${pid} > /dev/null; then
+    echo "Daemon with pid ${pid} not running anymore!\nFAILURE!";
+    exit 1
+fi
+
+kill -INT ${pid}
+trap - 0 2
+
+echo "Comparing expected vs actual output:"
+diff -u test.output.running test.output.expected
+
+# wait for the shutdown within the check interval
+sleep 10
+
+cleanup
+
+echo "SUCCESS!"
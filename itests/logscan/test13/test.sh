@@ -0,0 +1,47 @@
+#!/bin/sh
+
+set -eu
+
+BIN=../../../src/logscan/ctguard-logscan
+if ! [ -e ${BIN} ]; then
+    echo "Could not find binary at '${BIN}'!"
+    exit 1
+fi
+
+cleanup () {
+    rm -f test.log test.output test.state
+}
+
+cleanup
+
+chmod 640 test.conf
+touch test.log test.state
+
+${BIN} --cfg-file test.conf --unittest -f &
+pid=$!
+echo "Daemon running with pid ${pid}."
+
+trap "kill -9 ${pid}" 0 2
+
+sleep 0.5
+
+printf 'sshd: connection closed\nsshd: connection closed\nsshd: connection opened\nsshd: connection closed\n' >> test.log
+
+sleep 1
+
+if ! ps -p ${pid} > /dev/null; then
+    echo "Daemon with pid ${pid} not running anymore!\nFAILURE!";
+    exit 1
+fi
+
+# the summary is passed on at shutdown, long before the end of the window
+kill -INT ${pid}
+trap - 0 2
+wait ${pid}
+
+echo "Comparing expected vs actual output:"
+diff -u test.output test.output.expected
+
+cleanup
+
+echo "SUCCESS!"
@@ -0,0 +1,67 @@
+#!/bin/sh
+
+set -eu
+
+BIN=../../../src/logscan/ctguard-logscan
+if ! [ -e ${BIN} ]; then
+    echo "Could not find binary at '${BIN}'!"
+    exit 1
+fi
+
+FILES=$(seq 1 16)
+
+cleanup () {
+    rm -f test.conf test.output test.state
+    for f in ${FILES}; do
+        rm -f test${f}.log
+    done
+}
+
+cleanup
+
+for f in ${FILES}; do
+    touch test${f}.log
+    printf '  logfile "test%s.log"\n' "${f}" >> test.conf.files
+done
+sed -e '/@LOGFILES@/r test.conf.files' -e '/@LOGFILES@/d' test.conf.in > test.conf
+rm -f test.conf.files
+chmod 640 test.conf
+touch test.state
+
+${BIN} --cfg-file test.conf --unittest -f &
+pid=$!
+echo "Daemon running with pid ${pid}."
+
+trap "kill -9 ${pid}" 0 2
+
+sleep 0.5
+
+# files are read in parallel, but the lines of every file must stay in order
+for i in $(seq 1 50); do
+    for f in ${FILES}; do
+        echo "line ${i}" >> test${f}.log
+    done
+done
+
+sleep 2
+
+if ! ps -p ${pid} > /dev/null; then
+    echo "Daemon with pid ${pid} not running anymore!\nFAILURE!";
+    exit 1
+fi
+
+kill -INT ${pid}
+trap - 0 2
+
+sleep 2
+
+seq 1 50 | sed 's/^/line /' > test.expected
+for f in ${FILES}; do
+    echo "Comparing expected vs actual output of test${f}.log:"
+    grep "^ \[test${f}.log\] : " test.output | sed 's/^.* : //' | diff -u test.expected -
+done
+rm -f test.expected
+
+cleanup
+
+echo "SUCCESS!"
@@ -0,0 +1,76 @@
+#!/bin/sh
+
+set -eu
+
+BIN=../../../src/logscan/ctguard-logscan
+if ! [ -e ${BIN} ]; then
+    echo "Could not find binary at '${BIN}'!"
+    exit 1
+fi
+
+cleanup () {
+    rm -rf logs test.output test.output.running test.state
+}
+
+cleanup
+
+chmod 640 test.conf
+mkdir logs
+echo "old" > logs/a.log
+touch test.state
+
+${BIN} --cfg-file test.conf --unittest -f &
+pid=$!
+echo "Daemon running with pid ${pid}."
+
+trap "kill -9 ${pid}" 0 2
+
+sleep 0.5
+
+echo "a1" >> logs/a.log
+
+sleep 0.5
+
+# new matching files are read from the beginning
+printf 'b1\nb2\n' > logs/b.log
+echo "ignored" > logs/c.txt
+echo "hidden" > logs/.d.log
+
+sleep 0.5
+
+echo "b3" >> logs/b.log
+
+sleep 0.5
+
+printf 'e1\n' > logs/e.tmp
+mv logs/e.tmp logs/e.log
+
+sleep 0.5
+
+rm logs/b.log
+
+sleep 0.5
+
+# removed files are detached, a new one at the same path is discovered again
+echo "b4" > logs/b.log
+
+sleep 0.5
+
+cp test.output test.output.running
+
+if ! ps -p ${pid} > /dev/null; then
+    echo "Daemon with pid ${pid} not running anymore!\nFAILURE!";
+    exit 1
+fi
+
+kill -INT ${pid}
+trap - 0 2
+
+echo "Comparing expected vs actual output:"
+diff -u test.output.running test.output.expected
+
+sleep 1
+
+cleanup
+
+echo "SUCCESS!"
@@ -0,0 +1,78 @@
+#!/bin/sh
+
+set -eu
+
+BIN=../../../src/logscan/ctguard-logscan
+if ! [ -e ${BIN} ]; then
+    echo "Could not find binary at '${BIN}'!"
+    exit 1
+fi
+
+cleanup () {
+    rm -f test.log test.log.1 test.log.new test.output test.output.running test.state
+}
+
+cleanup
+
+chmod 640 test.conf
+touch test.log test.state
+
+${BIN} --cfg-file test.conf --unittest -f &
+pid=$!
+echo "Daemon running with pid ${pid}."
+
+trap "kill -9 ${pid}" 0 2
+
+sleep 0.5
+
+exec 3>>test.log
+echo "l1" >&3
+
+sleep 0.5
+
+# rename rotation: the lines written to the old file are read before switching
+printf 'l2\npartial' >&3
+touch test.log.new
+ln test.log test.log.1
+mv test.log.new test.log
+exec 3>>test.log
+echo "n1" >&3
+
+sleep 0.5
+
+# copytruncate: the new content is longer than the old one
+rm test.log.1
+cp test.log test.log.1
+: > test.log
+printf 'c1\nc2\n' >&3
+
+sleep 0.5
+
+# same content at a new inode is not read again
+cp test.log test.log.new
+mv test.log.new test.log
+exec 3>>test.log
+echo "c3" >&3
+
+sleep 0.5
+
+exec 3>&-
+
+cp test.output test.output.running
+
+if ! ps -p ${pid} > /dev/null; then
+    echo "Daemon with pid ${pid} not running anymore!\nFAILURE!";
+    exit 1
+fi
+
+kill -INT ${pid}
+trap - 0 2
+
+echo "Comparing expected vs actual output:"
+diff -u test.output.running test.output.expected
+
+sleep 1
+
+cleanup
+
+echo "SUCCESS!"
@@ -0,0 +1,60 @@
+#!/bin/sh
+
+set -eu
+
+BIN=../../../src/logscan/ctguard-logscan
+if ! [ -e ${BIN} ]; then
+    echo "Could not find binary at '${BIN}'!"
+    exit 1
+fi
+
+cleanup () {
+    rm -f test.log test_indent.log test.output test.output.running test.state
+}
+
+cleanup
+
+chmod 640 test.conf
+touch test.log test_indent.log test.state
+
+${BIN} --cfg-file test.conf --unittest -f &
+pid=$!
+echo "Daemon running with pid ${pid}."
+
+trap "kill -9 ${pid}" 0 2
+
+sleep 0.5
+
+printf '2021-01-01 12:00:00 ERROR request failed\njava.lang.NullPointerException: null\n\tat Foo.bar(Foo.java:42)\n' >> test.log
+
+sleep 0.5
+
+# the record continues across reads
+printf '\tat Foo.main(Foo.java:7)\n2021-01-01 12:00:01 INFO next\n' >> test.log
+
+# the last record is passed on by timeout, long before the check interval
+sleep 2
+
+printf 'Traceback (most recent call last):\n  File "x.py", line 1, in <module>\nValueError: y\n' >> test_indent.log
+
+sleep 2
+
+cp test.output test.output.running
+
+if ! ps -p ${pid} > /dev/null; then
+    echo "Daemon with pid ${pid} not running anymore!\nFAILURE!";
+    exit 1
+fi
+
+kill -INT ${pid}
+trap - 0 2
+
+echo "Comparing expected vs actual output:"
+diff -u test.output.running test.output.expected
+
+# wait for the shutdown within the check interval
+sleep 10
+
+cleanup
+
+echo "SUCCESS!"
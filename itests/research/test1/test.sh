@@ -9,7 +9,7 @@ if ! [ -e ${BIN} ]; then
 fi
 
 cleanup () {
-    rm -f test.output
+    rm -f test.output rules.cache
 }
 
 cleanup
@@ -0,0 +1,42 @@
+#!/bin/sh
+
+set -eu
+
+BIN=../../../src/research/ctguard-research
+if ! [ -e ${BIN} ]; then
+    echo "Could not find binary at '${BIN}'!"
+    exit 1
+fi
+
+cleanup () {
+    rm -f test.output.builtin test.output.parsed inputs.*
+}
+
+cleanup
+
+chmod 640 builtin.conf parsed.conf rules/*.xml
+chmod 750 rules
+
+# the input of the other research tests, from their input here-documents and literal log lines
+for test in ../test*/test.sh; do
+    name=$(basename "$(dirname "${test}")")
+    sed -n '/<< EOF$/,/^EOF$/{/EOF/!p}' "${test}" > "inputs.${name}"
+    sed -n 's/^ *echo "\([^$"]*\)" >> input.log$/\1/p' "${test}" >> "inputs.${name}"
+    echo quit >> "inputs.${name}"
+done
+
+# the builtin rules are the rules directory parsed at build time: both must process the inputs identically
+for input in test.input inputs.*; do
+    ${BIN} --cfg-file builtin.conf --input -f < "${input}" | grep -v '^Rules .* in [0-9]*ms$' > test.output.builtin
+    ${BIN} --cfg-file parsed.conf --input -f < "${input}" | grep -v '^Rules .* in [0-9]*ms$' > test.output.parsed
+
+    echo "Comparing builtin vs parsed output for ${input}:"
+    diff -u test.output.parsed test.output.builtin
+done
+
+${BIN} --cfg-file builtin.conf --input -f < test.input > test.output.builtin
+grep -q 'rule id  : 502020' test.output.builtin
+
+cleanup
+
+echo "SUCCESS!"
@@ -0,0 +1,97 @@
+#!/bin/sh
+
+set -eu
+
+BIN_RESEARCH=../../../src/research/ctguard-research
+if ! [ -e ${BIN_RESEARCH} ]; then
+    echo "Could not find binary at '${BIN_RESEARCH}'!"
+    exit 1
+fi
+
+BIN_LOGSCAN=../../../src/logscan/ctguard-logscan
+if ! [ -e ${BIN_LOGSCAN} ]; then
+    echo "Could not find binary at '${BIN_LOGSCAN}'!"
+    exit 1
+fi
+
+BIN_SMTPD=../../../src/test/fake_smtpd
+if ! [ -e ${BIN_SMTPD} ]; then
+    echo "Could not find binary at '${BIN_SMTPD}'!"
+    exit 1
+fi
+
+cleanup () {
+    rm -f logscan.state input.log alerts.log research.sock intervention.log research.state rules.cache research.conf smtpd.port smtpd.log
+}
+
+start_daemons () {
+    ${BIN_SMTPD} --pipelining smtpd.port smtpd.log &
+    smtpd_pid=$!
+    echo "fake smtp server running with pid ${smtpd_pid}."
+
+    sleep 1
+
+    sed "s/@PORT@/$(cat smtpd.port)/" research.conf.in > research.conf
+    chmod 640 research.conf
+
+    ${BIN_RESEARCH} --cfg-file research.conf -f -x &
+    research_pid=$!
+    echo "research daemon running with pid ${research_pid}."
+
+    sleep 1
+
+    ${BIN_LOGSCAN} --cfg-file logscan.conf -f -x &
+    logscan_pid=$!
+    echo "logscan daemon running with pid ${logscan_pid}."
+
+    trap "kill -9 ${research_pid}; kill -9 ${logscan_pid}; kill -9 ${smtpd_pid}" 0 2
+
+    sleep 1
+}
+
+stop_daemons () {
+    if ! ps -p ${logscan_pid} > /dev/null; then
+        echo "logscan daemon with pid ${logscan_pid} not running anymore!\nFAILURE!";
+        exit 1
+    fi
+
+    kill -INT ${logscan_pid}
+
+    if ! ps -p ${research_pid} > /dev/null; then
+        echo "research daemon with pid ${research_pid} not running anymore!\nFAILURE!";
+        exit 1
+    fi
+
+    kill -INT ${research_pid}
+
+    sleep 2
+
+    kill ${smtpd_pid}
+    trap - 0 2
+}
+
+cleanup
+
+chmod 640 logscan.conf rules.xml
+touch input.log
+
+start_daemons
+
+# two batches are sent as separate mails over one pipelined connection, closed at shutdown
+echo "scan from 10.0.0.1" >> input.log
+echo "scan from 10.0.0.2" >> input.log
+
+sleep 4
+
+echo "scan from 10.0.0.3" >> input.log
+
+sleep 4
+
+stop_daemons
+
+echo "Comparing expected vs actual smtp transcript:"
+diff -u test.smtp.expected smtpd.log
+
+cleanup
+
+echo "SUCCESS!"
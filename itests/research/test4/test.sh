@@ -15,7 +15,7 @@ if ! [ -e ${BIN_LOGSCAN} ]; then
 fi
 
 cleanup () {
-    rm -f logscan.state input.log alerts.log research.sock intervention.log
+    rm -f logscan.state input.log alerts.log research.sock intervention.log research.state rules.cache
 }
 
 cleanup
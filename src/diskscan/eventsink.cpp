@@ -4,7 +4,9 @@
 #include "../libs/logger.hpp"
 
 #include <cereal/archives/binary.hpp>
+#include <cereal/types/map.hpp>
 #include <cereal/types/memory.hpp>
+#include <cereal/types/string.hpp>
 
 #include <unistd.h>
 
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ctguard::libs {
+
+// 64-bit FNV-1a; not cryptographic, for fingerprints and keys of local data.
+// Stable across runs and builds, so usable for persisted data.
+[[nodiscard]] inline std::uint64_t fnv1a(const void * data, std::size_t size, std::uint64_t hash = 14695981039346656037ULL) noexcept
+{
+    const auto * bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+[[nodiscard]] inline std::uint64_t fnv1a(std::string_view str) noexcept { return fnv1a(str.data(), str.size()); }
+
+// splitmix64 finalizer, spreads the entropy over all bits
+[[nodiscard]] inline std::uint64_t mix64(std::uint64_t x) noexcept
+{
+    x ^= x >> 30U;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27U;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31U;
+    return x;
+}
+
+} /* namespace ctguard::libs */
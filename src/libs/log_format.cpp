@@ -0,0 +1,85 @@
+#include "log_format.hpp"
+
+#include <cctype>
+
+#include "libexception.hpp"
+
+namespace ctguard::libs {
+
+static std::string trim(std::string_view str)
+{
+    std::string::size_type begin = 0;
+    std::string::size_type end = str.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(str[begin])) != 0) {
+        ++begin;
+    }
+    while (end > begin && std::isspace(static_cast<unsigned char>(str[end - 1])) != 0) {
+        --end;
+    }
+
+    return std::string{ str.substr(begin, end - begin) };
+}
+
+log_format parse_log_format(const xml::XMLNodeView & node)
+{
+    log_format f;
+
+    for (auto const & attr : node.attributes()) {
+        if (attr.first == "name") {
+            f.name = attr.second;
+
+        } else {
+            throw lib_exception{ "Invalid attribute for format node: '" + std::string{ attr.first } + "'" };
+        }
+    }
+
+    for (auto const & sub_node : node.children()) {
+        if (sub_node.name() == "regex") {
+            if (!sub_node.attributes().empty()) {
+                const auto & attr = sub_node.attributes().cbegin();
+                throw lib_exception{ "Invalid attribute for format node: '" + std::string{ attr->first } + "'" };
+            }
+            f.regex += sub_node.value();
+
+        } else if (sub_node.name() == "fields") {
+            if (!sub_node.attributes().empty()) {
+                const auto & attr = sub_node.attributes().cbegin();
+                throw lib_exception{ "Invalid attribute for fields node: '" + std::string{ attr->first } + "'" };
+            }
+
+            const std::string_view fields_str = sub_node.value();
+
+            std::size_t current = fields_str.find(',');
+            std::size_t previous = 0;
+            while (current != std::string::npos) {
+                f.fields.push_back(trim(fields_str.substr(previous, current - previous)));
+                previous = current + 1;
+                current = fields_str.find(',', previous);
+            }
+            f.fields.push_back(trim(fields_str.substr(previous, current - previous)));
+
+        } else {
+            throw lib_exception{ "Unsupported format node child: " + std::string{ sub_node.name() } };
+        }
+    }
+
+    // validate format
+    if (f.name.empty()) {
+        throw lib_exception{ "No name given for format" };
+    }
+    if (f.regex.empty()) {
+        throw lib_exception{ "No regex given for format '" + f.name + "'" };
+    }
+    try {
+        f.reg = f.regex;
+        if (f.reg.mark_count() != f.fields.size()) {
+            throw lib_exception{ "Number of regex fields mismatch (" + std::to_string(f.reg.mark_count()) + " != " + std::to_string(f.fields.size()) + ")" };
+        }
+    } catch (const std::exception & e) {
+        throw lib_exception{ "Invalid regex '" + f.regex + "' for format '" + f.name + "': " + e.what() };
+    }
+
+    return f;
+}
+
+} /* namespace ctguard::libs */
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "xml/XMLNodeView.hpp"
+
+namespace ctguard::libs {
+
+// A <format> definition of a research rules file, shared by research and the format extraction of logscan.
+struct log_format
+{
+    std::string name;
+    std::string regex;  // source of reg
+    std::regex reg;
+    std::vector<std::string> fields;  // names of the marked subexpressions of reg
+};
+
+using format_match = std::match_results<std::string_view::const_iterator>;
+
+// Parse and validate a <format> node; throws lib_exception on invalid definitions.
+[[nodiscard]] log_format parse_log_format(const xml::XMLNodeView & node);
+
+// The part of a log message formats are matched against: the fields of a multi-line record come from its first line.
+[[nodiscard]] inline std::string_view format_input(std::string_view message) { return message.substr(0, message.find('\n')); }
+
+} /* namespace ctguard::libs */
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <map>
 #include <string>
 
 namespace ctguard::libs {
@@ -18,11 +19,16 @@ class source_event
     std::string message;
     bool control_message{ false };
     sevent_time_t time_scanned{ 0 }, time_send{ 0 };
+    // set if the sender already matched the research formats; format 'unknown' if none matched
+    std::string format;
+    std::map<std::string, std::string> fields;
+    // number of identical messages folded into this one by the sender
+    unsigned repeats{ 0 };
 
     template<class Archive>
     void serialize(Archive & archive)
     {
-        archive(hostname, source_program, source_domain, message, control_message, time_scanned, time_send);
+        archive(hostname, source_program, source_domain, message, control_message, time_scanned, time_send, format, fields, repeats);
     }
 };
 
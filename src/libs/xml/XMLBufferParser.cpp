@@ -0,0 +1,237 @@
+#include "XMLBufferParser.hpp"
+
+#include <cstdio>  // EOF
+#include <sstream>
+
+#include "xmlexception.hpp"
+
+namespace ctguard::libs::xml {
+
+// Collects the characters of a name or value.
+// As long as they are contiguous in the input only a view is kept, otherwise they are copied into the arena.
+class XMLBufferParser::text_builder
+{
+  public:
+    explicit text_builder(std::string_view input) : m_input{ input } {}
+
+    void append(char c, std::size_t offset)
+    {
+        if (m_copied) {
+            m_copy += c;
+        } else if (m_length == 0) {
+            m_start = offset;
+            m_length = 1;
+        } else if (offset == m_start + m_length) {
+            ++m_length;
+        } else {
+            m_copy.assign(m_input.substr(m_start, m_length));
+            m_copy += c;
+            m_copied = true;
+        }
+    }
+
+    void clear() noexcept
+    {
+        m_length = 0;
+        m_copy.clear();
+        m_copied = false;
+    }
+
+    [[nodiscard]] std::string_view view() const noexcept { return m_copied ? std::string_view{ m_copy } : m_input.substr(m_start, m_length); }
+
+    [[nodiscard]] std::string_view finish(std::deque<std::string> & arena)
+    {
+        if (!m_copied) {
+            return m_input.substr(m_start, m_length);
+        }
+
+        return arena.emplace_back(std::move(m_copy));
+    }
+
+  private:
+    std::string_view m_input;
+    std::size_t m_start{ 0 }, m_length{ 0 };
+    std::string m_copy;
+    bool m_copied{ false };
+};
+
+int XMLBufferParser::peek() const noexcept
+{
+    return m_offset < m_input.size() ? m_input[m_offset] : EOF;
+}
+
+char XMLBufferParser::get_char_raw()
+{
+    for (;;) {
+        if (m_offset >= m_input.size()) {
+            parse_error("Unexpected stream error/end");
+        }
+
+        const char c{ m_input[m_offset++] };
+
+        if (c == '\n') {
+            ++m_line;
+            m_position = 0;
+            continue;
+        }
+
+        ++m_position;
+        return c;
+    }
+}
+
+char XMLBufferParser::get_char()
+{
+    for (;;) {
+        char c{ get_char_raw() };
+
+        if (c != '<' || peek() != '!') {
+            return c;
+        }
+
+        ++m_offset;
+        ++m_position;  // consume '!'
+
+        if ((c = get_char_raw()) != '-' || peek() != '-') {
+            parse_error(std::string("Unknown command sequence '") + c + "'");
+        }
+        ++m_offset;
+        ++m_position;  // consume second '-'
+
+        while (get_char_raw() != '-' || peek() != '-') {
+        }
+
+        ++m_offset;
+        ++m_position;  // consume second '-'
+
+        if ((c = get_char_raw()) != '>') {
+            parse_error(std::string("Expected closing of command sequence instead of '") + c + "'");
+        }
+    }
+}
+
+XMLNodeView XMLBufferParser::parse()
+{
+    text_builder name{ m_input };
+    text_builder value{ m_input };
+    text_builder close_name{ m_input };
+    text_builder attr_key{ m_input };
+    text_builder attr_value{ m_input };
+    std::vector<std::pair<std::string_view, std::string_view>> attributes;
+    std::vector<XMLNodeView> children;
+    parse_state state{ parse_state::initial };
+
+    while (char c = get_char()) {
+        switch (state) {
+            case parse_state::initial:
+                while (std::isspace(c)) {
+                    c = get_char();
+                }
+                if (c == '<') {
+                    state = parse_state::open_tag_key;
+                } else {
+                    parse_error(std::string("Unknown character (1) '") + c + "'");
+                }
+                break;
+            case parse_state::open_tag_key:
+                while (std::isalnum(c) || c == '_') {
+                    name.append(c, m_offset - 1);
+                    c = get_char();
+                }
+                --m_offset;  // unget
+                state = parse_state::open_tag_attr;
+                break;
+            case parse_state::body:
+                while (c != '<' && (std::isprint(c) || c == '\t')) {
+                    if (c != '\t') {
+                        value.append(c, m_offset - 1);
+                    }
+                    c = get_char();
+                }
+                if (c == '<' && peek() == '/') {
+                    ++m_offset;
+                    ++m_position;  // consume '/'
+                    state = parse_state::close_tag;
+                } else if (c == '<') {
+                    --m_offset;  // unget
+                    children.push_back(parse());
+                } else {
+                    parse_error(std::string("Unknown character (2) '") + c + "'");
+                }
+                break;
+            case parse_state::attr_key:
+                attr_key.clear();
+                while (std::isalnum(c) || c == '_') {
+                    attr_key.append(c, m_offset - 1);
+                    c = get_char();
+                }
+                for (const auto & attrs : attributes) {
+                    if (attrs.first == attr_key.view()) {
+                        parse_error("Attribute '" + std::string{ attr_key.view() } + "' already defined");
+                    }
+                }
+                if (c == '=' && peek() == '"') {
+                    ++m_offset;
+                    ++m_position;  // consume '"'
+                    state = parse_state::attr_value;
+                } else {
+                    parse_error(std::string("Unknown character (3) '") + c + "', expected '='");
+                }
+                break;
+            case parse_state::attr_value:
+                attr_value.clear();
+                while (c != '"' && std::isprint(c)) {
+                    attr_value.append(c, m_offset - 1);
+                    c = get_char();
+                }
+                if (c == '"') {
+                    attributes.emplace_back(attr_key.finish(m_arena), attr_value.finish(m_arena));
+                    state = parse_state::open_tag_attr;
+                } else {
+                    parse_error(std::string("Unknown character (4) '") + c + "'");
+                }
+                break;
+            case parse_state::open_tag_attr:
+                while (std::isspace(c)) {
+                    c = get_char();
+                }
+                if (std::isalnum(c)) {
+                    state = parse_state::attr_key;
+                    --m_offset;  // unget
+                } else if (c == '/' && peek() == '>') {
+                    ++m_offset;
+                    ++m_position;  // consume '>'
+                    return XMLNodeView{ name.finish(m_arena), std::move(attributes) };
+                } else if (c == '>') {
+                    state = parse_state::body;
+                } else {
+                    parse_error(std::string("Unknown character (5) '") + c + "'");
+                }
+                break;
+            case parse_state::close_tag:
+                while (std::isalnum(c) || c == '_') {
+                    close_name.append(c, m_offset - 1);
+                    c = get_char();
+                }
+                if (c == '>') {
+                    if (name.view() != close_name.view()) {
+                        parse_error("Tag '" + std::string{ name.view() } + "' not closed while closing tag '" + std::string{ close_name.view() } + "'");
+                    }
+                    return XMLNodeView{ name.finish(m_arena), std::move(attributes), value.finish(m_arena), std::move(children) };
+                }
+
+                parse_error(std::string("Unknown character (6) '") + c + "'");
+        }
+    }
+
+    parse_error("Unexpected end, while in tag '" + std::string{ name.view() } + "'");
+}
+
+void XMLBufferParser::parse_error(std::string_view message) const
+{
+    std::ostringstream os;
+    os << m_line << ":" << (m_position - 1) << ": " << message;
+    throw xml_exception{ os.str() };
+}
+
+} /* namespace ctguard::libs::xml */
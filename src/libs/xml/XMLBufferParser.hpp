@@ -0,0 +1,45 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+
+#include "XMLNodeView.hpp"
+
+namespace ctguard::libs::xml {
+
+// Parser over an in-memory buffer with the same grammar as XMLparser.
+class XMLBufferParser
+{
+    enum class parse_state
+    {
+        initial,
+        open_tag_key,
+        open_tag_attr,
+        body,
+        close_tag,
+        attr_key,
+        attr_value
+    };
+
+  public:
+    XMLBufferParser(std::string_view input, std::deque<std::string> & arena) : m_input{ input }, m_arena{ arena } {}
+
+    [[nodiscard]] XMLNodeView parse();
+
+  private:
+    class text_builder;
+
+    std::string_view m_input;
+    std::deque<std::string> & m_arena;
+    std::size_t m_offset{ 0 };
+    static_assert(std::is_unsigned<std::size_t>::value, "signed overflow");
+    std::size_t m_line{ 1 }, m_position{ 0 };
+
+    [[noreturn]] void parse_error(std::string_view message) const;
+    [[nodiscard]] int peek() const noexcept;
+    [[nodiscard]] char get_char();
+    [[nodiscard]] char get_char_raw();
+};
+
+} /* namespace ctguard::libs::xml */
@@ -0,0 +1,65 @@
+#include "XMLDocument.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>  // strerror
+
+#include "XMLBufferParser.hpp"
+#include "xmlexception.hpp"
+
+namespace ctguard::libs::xml {
+
+XMLDocument::XMLDocument(std::vector<char> buffer) : m_buffer{ std::move(buffer) }
+{
+    XMLBufferParser parser{ std::string_view{ m_buffer.data(), m_buffer.size() }, m_arena };
+    m_root.emplace(parser.parse());
+}
+
+XMLDocument XMLDocument::load_file(const std::string & path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    if (fd == -1) {
+        throw xml_exception{ "Can not open '" + path + "': " + ::strerror(errno) };
+    }
+
+    std::vector<char> buffer;
+    {
+        struct ::stat info;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+        if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+            buffer.reserve(static_cast<std::size_t>(info.st_size));
+        }
+    }
+
+    // read the whole file, it might have changed its size since fstat()
+    std::size_t length{ 0 };
+    for (;;) {
+        if (buffer.capacity() - length < 4096) {
+            buffer.reserve(buffer.capacity() * 2 + 4096);
+        }
+        buffer.resize(buffer.capacity());
+
+        const ssize_t ret = ::read(fd, buffer.data() + length, buffer.size() - length);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            const int saved_errno = errno;
+            ::close(fd);
+            throw xml_exception{ "Can not read '" + path + "': " + ::strerror(saved_errno) };
+        }
+        if (ret == 0) {
+            break;
+        }
+        length += static_cast<std::size_t>(ret);
+    }
+    ::close(fd);
+
+    buffer.resize(length);
+
+    return XMLDocument{ std::move(buffer) };
+}
+
+} /* namespace ctguard::libs::xml */
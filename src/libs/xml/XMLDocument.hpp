@@ -0,0 +1,35 @@
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "XMLNodeView.hpp"
+
+namespace ctguard::libs::xml {
+
+// XML document parsed from an owned buffer.
+// Node names and values point into the buffer; values which are not contiguous in the input
+// (e.g. due to skipped newlines, dropped tabs or comments) are stored in the document arena.
+class XMLDocument
+{
+  public:
+    explicit XMLDocument(std::vector<char> buffer);
+    XMLDocument(const XMLDocument &) = delete;
+    XMLDocument & operator=(const XMLDocument &) = delete;
+    XMLDocument(XMLDocument &&) = default;
+    XMLDocument & operator=(XMLDocument &&) = default;
+    ~XMLDocument() = default;
+
+    [[nodiscard]] static XMLDocument load_file(const std::string & path);
+
+    [[nodiscard]] const XMLNodeView & root() const noexcept { return *m_root; }
+
+  private:
+    std::vector<char> m_buffer;
+    std::deque<std::string> m_arena;
+    std::optional<XMLNodeView> m_root;
+};
+
+} /* namespace ctguard::libs::xml */
@@ -0,0 +1,37 @@
+#include "XMLNodeView.hpp"
+
+namespace ctguard::libs::xml {
+
+XMLNodeView::XMLNodeView(std::string_view name, std::vector<std::pair<std::string_view, std::string_view>> attributes)
+  : m_name{ name }, m_attributes{ std::move(attributes) }
+{}
+
+XMLNodeView::XMLNodeView(std::string_view name, std::vector<std::pair<std::string_view, std::string_view>> attributes, std::string_view value,
+                         std::vector<XMLNodeView> children)
+  : m_name{ name }, m_attributes{ std::move(attributes) }, m_value{ value }, m_children{ std::move(children) }
+{}
+
+std::ostream & operator<<(std::ostream & out, const XMLNodeView & node)
+{
+    out << '<' << node.m_name;
+
+    for (const auto & attr : node.m_attributes) {
+        out << " " << attr.first << "=\"" << attr.second << "\"";
+    }
+
+    out << '>';
+
+    if (!node.m_value.empty()) {
+        out << node.m_value;
+    }
+
+    for (const XMLNodeView & n : node.m_children) {
+        out << n;
+    }
+
+    out << "</" << node.m_name << ">";
+
+    return out;
+}
+
+} /* namespace ctguard::libs::xml */
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ctguard::libs::xml {
+
+// Node of a XMLDocument; all names and values are views into the document and only valid during its lifetime.
+class XMLNodeView
+{
+  public:
+    XMLNodeView(std::string_view name, std::vector<std::pair<std::string_view, std::string_view>> attributes);
+    XMLNodeView(std::string_view name, std::vector<std::pair<std::string_view, std::string_view>> attributes, std::string_view value,
+                std::vector<XMLNodeView> children);
+
+    [[nodiscard]] std::string_view name() const noexcept { return m_name; }
+    [[nodiscard]] std::string_view value() const noexcept { return m_value; }
+    [[nodiscard]] const std::vector<XMLNodeView> & children() const noexcept { return m_children; }
+    [[nodiscard]] const std::vector<std::pair<std::string_view, std::string_view>> & attributes() const noexcept { return m_attributes; }
+
+    friend std::ostream & operator<<(std::ostream & out, const XMLNodeView & node);
+
+  private:
+    std::string_view m_name;
+    std::vector<std::pair<std::string_view, std::string_view>> m_attributes;
+    std::string_view m_value;
+    std::vector<XMLNodeView> m_children;
+};
+
+} /* namespace ctguard::libs::xml */
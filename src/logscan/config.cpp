@@ -2,6 +2,7 @@
 
 #include <fstream>  // std::ifstream
 #include <iomanip>  // std::setw
+#include <regex>
 
 #include "../libs/config/parser.hpp"
 #include "../libs/errnoexception.hpp"
@@ -9,6 +10,12 @@
 
 namespace ctguard::logscan {
 
+bool is_glob_pattern(const std::string & path)
+{
+    const auto slash = path.rfind('/');
+    return path.find_first_of("*?[", slash == std::string::npos ? 0 : slash + 1) != std::string::npos;
+}
+
 logscan_config parse_config(const std::string & cfg_path)
 {
     logscan_config cfg;
@@ -43,7 +50,7 @@ logscan_config parse_config(const std::string & cfg_path)
 
             } else if (a.first == "state_file_interval") {
                 try {
-                    cfg.check_interval = libs::parse_integral<unsigned int>(a.second.options[0]);
+                    cfg.state_file_interval = libs::parse_second_duration(a.second.options);
                 } catch (const std::exception & e) {
                     throw std::out_of_range{ "Invalid argument for configuration '" + a.first + "' given: " + e.what() };
                 }
@@ -101,6 +108,46 @@ logscan_config parse_config(const std::string & cfg_path)
                     throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
                 }
 
+            } else if (a.first == "inotify") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+                try {
+                    cfg.inotify = libs::parse_bool(a.second.options[0]);
+                } catch (const std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+
+            } else if (a.first == "systemd_rcvbuf") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+                try {
+                    cfg.systemd_rcvbuf = libs::parse_integral<unsigned>(a.second.options[0]);
+                } catch (const std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+
+            } else if (a.first == "reader_threads") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+                try {
+                    cfg.reader_threads = libs::parse_integral<unsigned>(a.second.options[0]);
+                } catch (const std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+
+            } else if (a.first == "formats_file") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+                cfg.formats_file = a.second.options[0];
+
             } else {
                 throw std::out_of_range{ "Invalid configuration option '" + a.first + "' in group logscan at " + to_string(a.second.pos) };
             }
@@ -114,6 +161,9 @@ logscan_config parse_config(const std::string & cfg_path)
                 if (b.keyword().empty()) {
                     throw std::out_of_range{ "Empty key for configuration group '" + b.name() + "' at " + to_string(b.pos()) };
                 }
+                if (const auto slash = lc.path.rfind('/'); slash != std::string::npos && lc.path.find_first_of("*?[") < slash) {
+                    throw std::out_of_range{ "Wildcards are only supported in the file name for configuration group '" + b.name() + "' at " + to_string(b.pos()) };
+                }
                 for (const auto & c : logfile) {
                     if (c.first == "timeout_warning") {
                         try {
@@ -122,6 +172,57 @@ logscan_config parse_config(const std::string & cfg_path)
                             throw std::out_of_range{ "Invalid argument '" + c.second.options[0] + "' for configuration " + c.first + " given: " + e.what() };
                         }
 
+                    } else if (c.first == "multiline") {
+                        const auto & options = c.second.options;
+                        if (options.size() == 1 && options[0] == "none") {
+                            lc.multiline.mode = multiline_config::mode_t::NONE;
+                        } else if (options.size() == 1 && options[0] == "indent") {
+                            lc.multiline.mode = multiline_config::mode_t::INDENT;
+                        } else if (options.size() == 2 && options[0] == "start") {
+                            try {
+                                const std::regex check{ options[1] };
+                            } catch (const std::regex_error & e) {
+                                throw std::out_of_range{ "Invalid regex '" + options[1] + "' for configuration " + c.first + " at " + to_string(c.second.pos) + ": " + e.what() };
+                            }
+                            lc.multiline.mode = multiline_config::mode_t::START;
+                            lc.multiline.start = options[1];
+                        } else {
+                            throw std::out_of_range{ "Invalid arguments for configuration " + c.first + " at " + to_string(c.second.pos) };
+                        }
+
+                    } else if (c.first == "dedup_window") {
+                        try {
+                            lc.dedup_window = libs::parse_second_duration(c.second.options);
+                        } catch (const std::exception & e) {
+                            throw std::out_of_range{ "Invalid argument '" + c.second.options[0] + "' for configuration " + c.first + " given: " + e.what() };
+                        }
+
+                    } else if (c.first == "drop" || c.first == "keep") {
+                        if (c.second.options.empty()) {
+                            throw std::out_of_range{ "No argument for configuration " + c.first + " at " + to_string(c.second.pos) };
+                        }
+                        (c.first == "drop" ? lc.filter.drop : lc.filter.keep) = c.second.options;
+
+                    } else if (c.first == "drop_regex" || c.first == "keep_regex") {
+                        if (c.second.options.empty()) {
+                            throw std::out_of_range{ "No argument for configuration " + c.first + " at " + to_string(c.second.pos) };
+                        }
+                        for (const auto & r : c.second.options) {
+                            try {
+                                const std::regex check{ r };
+                            } catch (const std::regex_error & e) {
+                                throw std::out_of_range{ "Invalid regex '" + r + "' for configuration " + c.first + " at " + to_string(c.second.pos) + ": " + e.what() };
+                            }
+                        }
+                        (c.first == "drop_regex" ? lc.filter.drop_regex : lc.filter.keep_regex) = c.second.options;
+
+                    } else if (c.first == "multiline_timeout") {
+                        try {
+                            lc.multiline.timeout = libs::parse_second_duration(c.second.options);
+                        } catch (const std::exception & e) {
+                            throw std::out_of_range{ "Invalid argument '" + c.second.options[0] + "' for configuration " + c.first + " given: " + e.what() };
+                        }
+
                     } else {
                         throw std::out_of_range{ "Invalid configuration option '" + c.second.key + "' in group logfile at " + to_string(c.second.pos) };
                     }
@@ -160,16 +261,47 @@ std::ostream & operator<<(std::ostream & os, const logscan_config & cfg)
 {
     os << "START config dump\n"
        << "    check_interval      = " << cfg.check_interval << " second(s)\n"
+       << "    formats_file        = " << cfg.formats_file << "\n"
+       << "    inotify             = " << std::boolalpha << cfg.inotify << "\n"
        << "    log_path            = " << cfg.log_path << "\n"
        << "    output_kind         = " << cfg.output_kind << "\n"
        << "    output_path         = " << cfg.output_path << "\n"
+       << "    reader_threads      = " << cfg.reader_threads << "\n"
        << "    state_file          = " << cfg.state_file << "\n"
-       << "    state_file_interval = " << cfg.state_file_interval << " (relative to check_interval)\n"
+       << "    state_file_interval = " << cfg.state_file_interval << " second(s)\n"
        << "    systemd_input       = " << std::boolalpha << cfg.systemd_input << "\n"
+       << "    systemd_rcvbuf      = " << cfg.systemd_rcvbuf << " byte(s)\n"
        << "    systemd_socket      = " << cfg.systemd_socket << "\n"
        << "    logfiles:\n";
     for (const auto & logfile : cfg.log_files) {
-        os << "        path: " << std::setw(20) << logfile.path << ", timeout_warning: " << logfile.timeout_alert << " second(s)\n";
+        os << "        path: " << std::setw(20) << logfile.path << ", timeout_warning: " << logfile.timeout_alert << " second(s)";
+        switch (logfile.multiline.mode) {
+            case multiline_config::mode_t::NONE:
+                break;
+            case multiline_config::mode_t::START:
+                os << ", multiline: start '" << logfile.multiline.start << "' within " << logfile.multiline.timeout << " second(s)";
+                break;
+            case multiline_config::mode_t::INDENT:
+                os << ", multiline: indent within " << logfile.multiline.timeout << " second(s)";
+                break;
+        }
+        if (logfile.dedup_window != 0) {
+            os << ", dedup_window: " << logfile.dedup_window << " second(s)";
+        }
+        const auto patterns = [&os](const char * name, const std::vector<std::string> & list) {
+            if (list.empty()) {
+                return;
+            }
+            os << ", " << name << ":";
+            for (const auto & p : list) {
+                os << " '" << p << "'";
+            }
+        };
+        patterns("drop", logfile.filter.drop);
+        patterns("drop_regex", logfile.filter.drop_regex);
+        patterns("keep", logfile.filter.keep);
+        patterns("keep_regex", logfile.filter.keep_regex);
+        os << "\n";
     }
     os << "END config dump\n";
     return os;
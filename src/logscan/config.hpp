@@ -5,12 +5,43 @@
 
 namespace ctguard::logscan {
 
+struct multiline_config
+{
+    enum class mode_t : char
+    {
+        NONE,
+        START,   // records begin with a line matching start
+        INDENT,  // continuation lines begin with whitespace
+    };
+
+    mode_t mode{ mode_t::NONE };
+    std::string start;
+    unsigned timeout{ 1 };
+};
+
+struct line_filter_config
+{
+    std::vector<std::string> drop;  // literal substrings
+    std::vector<std::string> drop_regex;
+    std::vector<std::string> keep;  // exceptions from drop
+    std::vector<std::string> keep_regex;
+
+    [[nodiscard]] bool empty() const noexcept { return drop.empty() && drop_regex.empty(); }
+};
+
 struct logfile_config
 {
     std::string path;
     unsigned timeout_alert{ 0 };
+    std::string pattern;  // the configured pattern, for files discovered by one
+    multiline_config multiline;
+    unsigned dedup_window{ 0 };
+    line_filter_config filter;
 };
 
+// Whether the file name of path contains wildcards.
+[[nodiscard]] bool is_glob_pattern(const std::string & path);
+
 enum class output_kind_t
 {
     SOCKET,
@@ -21,6 +52,8 @@ struct logscan_config
 {
     std::vector<logfile_config> log_files;
     unsigned check_interval{ 1 };
+    bool inotify{ true };
+    unsigned reader_threads{ 0 };
     unsigned state_file_interval{ 30 };
     output_kind_t output_kind{ output_kind_t::SOCKET };
     std::string state_file{ "/var/lib/ctguard/logscan.state" };
@@ -28,6 +61,8 @@ struct logscan_config
     std::string log_path{ "/var/log/ctguard/logscan.log" };
     std::string systemd_socket{ "/run/systemd/journal/syslog" };
     bool systemd_input{ true };
+    unsigned systemd_rcvbuf{ 0 };
+    std::string formats_file{ "" };
 };
 
 [[nodiscard]] logscan_config parse_config(const std::string & cfg_path);
@@ -1,35 +1,53 @@
 #include "daemon.hpp"
 
 #include <fcntl.h>
+#include <glob.h>
 
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
 #include <unistd.h>  // ::close
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <csignal>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <optional>
+#include <set>
 #include <sstream>
 #include <stack>
 #include <thread>
 
 #include "../libs/blockedqueue.hpp"
+#include "../libs/check_file_perms.hpp"
 #include "../libs/errnoexception.hpp"
+#include "../libs/libexception.hpp"
 #include "../libs/logger.hpp"
 #include "../libs/scopeguard.hpp"
 #include "../libs/source_event.hpp"
 
 #include "eventsink.hpp"
+#include "file_watcher.hpp"
+#include "formats.hpp"
+#include "line_reader.hpp"
 #include "logfile.hpp"
+#include "reader_pool.hpp"
+#include "state_store.hpp"
+#include "systemd_receiver.hpp"
 
 namespace ctguard::logscan {
 
 using errorstack_t = std::pair<std::mutex, std::stack<std::exception_ptr>>;
-using state_t = std::vector<std::tuple<std::string, logfile::inode_type, logfile::pos_type>>;
+
+static constexpr std::time_t RESCAN_INTERVAL{ 60 };
+static constexpr std::time_t DROP_REPORT_INTERVAL{ 3600 };
+static constexpr unsigned SYSTEMD_BATCH{ 1024 };
 
 static std::atomic<bool> RUNNING{ true };
 static bool UNIT_TEST{ false };
@@ -48,102 +66,405 @@ static bool UNIT_TEST{ false };
     return se;
 }
 
-[[nodiscard]] static state_t get_state(const std::string & path)
+[[nodiscard]] static int open_logfile(const std::string & path)
 {
-    state_t state;
-    std::ifstream state_file{ path };
-    if (!state_file.is_open()) {
-        if (errno == ENOENT) {
-            FILE_LOG(libs::log_level::INFO) << "No statefile; clean start";
-        } else {
-            FILE_LOG(libs::log_level::ERROR) << "Can not open state file '" << path << "' : " << ::strerror(errno);
-            FILE_LOG(libs::log_level::WARNING) << "Ignoring state file; clean start";
-        }
-    } else {
-        std::string line;
-        while (std::getline(state_file, line)) {
-            if (line.empty()) {
-                continue;
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    if (fd != -1) {
+        line_reader::advise_sequential(fd);
+    }
+    return fd;
+}
+
+static void save_state(state_store & store, const std::vector<logfile> & log_states)
+{
+    FILE_LOG(libs::log_level::DEBUG) << "Saving state...";
+    for (const auto & ls : log_states) {
+        store.update(ls.path(), state_store::entry{ ls.get_inode(), static_cast<std::uint64_t>(std::streamoff{ ls.get_position() }), ls.get_fingerprint(),
+                                                    static_cast<std::uint32_t>(ls.get_fingerprint_length()) });
+    }
+    store.flush();
+    FILE_LOG(libs::log_level::DEBUG) << "State saved";
+}
+
+enum class scan_result : char
+{
+    UNCHANGED,
+    REOPENED,  // needs to be watched again
+    REMOVED,   // discovered by a pattern and deleted, to be detached
+};
+
+// Remember the start of the file, once enough of it was written.
+static void update_fingerprint(logfile & ls, off_t size)
+{
+    const std::size_t length = std::min(line_reader::FINGERPRINT_SIZE, static_cast<std::size_t>(size));
+    if (length <= ls.get_fingerprint_length()) {
+        return;
+    }
+
+    if (const auto fp = line_reader::fingerprint(ls.fd(), length); fp.has_value()) {
+        ls.set_fingerprint(*fp, length);
+    }
+}
+
+// Whether the file currently opened still starts with the content already read.
+[[nodiscard]] static bool same_content(logfile & ls)
+{
+    if (ls.get_fingerprint_length() == 0) {
+        return true;
+    }
+
+    const auto fp = line_reader::fingerprint(ls.fd(), ls.get_fingerprint_length());
+    return !fp.has_value() || *fp == ls.get_fingerprint();
+}
+
+static void send_record(logfile & ls, std::string record, const format_extractor * formats, libs::blocked_queue<libs::source_event> & queue)
+{
+    if (auto & lf = ls.filter(); lf.has_value() && !lf->pass(record)) {
+        FILE_LOG(libs::log_level::DEBUG2) << "Dropping line from '" << ls.path() << "': '" << record << "'";
+        return;
+    }
+
+    if (auto & rf = ls.repeats(); rf.has_value() && !rf->pass(record, repeat_folder::clock::now())) {
+        return;
+    }
+
+    libs::source_event se{ log_2_se(ls.path(), false, std::move(record)) };
+    if (formats != nullptr) {
+        formats->extract(se);
+    }
+    queue.emplace(std::move(se));
+}
+
+// Log the number of lines dropped by the filter of ls, unless unchanged since the last report and not forced.
+static void report_dropped(logfile & ls, bool force)
+{
+    if (auto & lf = ls.filter(); lf.has_value() && (lf->take_changed() || force)) {
+        FILE_LOG(libs::log_level::INFO) << "Dropped " << lf->dropped() << " line(s) from '" << ls.path() << "' since start";
+    }
+}
+
+// Send the summaries of lines of ls repeated within a window over at now.
+static void send_repeats(logfile & ls, repeat_folder::clock::time_point now, const format_extractor * formats, libs::blocked_queue<libs::source_event> & queue)
+{
+    if (auto & rf = ls.repeats(); rf.has_value()) {
+        for (auto & [message, repeats] : rf->expire(now)) {
+            libs::source_event se{ log_2_se(ls.path(), false, std::move(message)) };
+            se.repeats = repeats;
+            if (formats != nullptr) {
+                formats->extract(se);
             }
+            queue.emplace(std::move(se));
+        }
+    }
+}
 
-            FILE_LOG(libs::log_level::DEBUG) << "State file line: '" << line << "'";
-            const auto pathpos = line.find('"', 1);
-            if (pathpos == std::string::npos) {
-                FILE_LOG(libs::log_level::ERROR) << "State file '" << path << "' has invalid line: '" << line << "'";
-                continue;
+// Send the pending multi-line record of ls, if any.
+static void flush_record(logfile & ls, const format_extractor * formats, libs::blocked_queue<libs::source_event> & queue)
+{
+    if (auto & ml = ls.multiline(); ml.has_value()) {
+        if (auto record = ml->flush(); record.has_value()) {
+            send_record(ls, std::move(*record), formats, queue);
+        }
+    }
+}
+
+// Check a logfile for changes and read its new lines.
+static scan_result scan_logfile(logfile & ls, line_reader & reader, const format_extractor * formats, libs::blocked_queue<libs::source_event> & queue)
+{
+    scan_result result{ scan_result::UNCHANGED };
+
+    const auto emit = [&ls, formats, &queue](std::string_view line) {
+        FILE_LOG(libs::log_level::DEBUG) << "Line got from '" << ls.path() << "': '" << line << "'";
+
+        ls.update_time();
+        ls.timeout_triggered(false);
+        if (auto & ml = ls.multiline(); ml.has_value()) {
+            if (auto record = ml->push(line); record.has_value()) {
+                send_record(ls, std::move(*record), formats, queue);
             }
+        } else {
+            send_record(ls, std::string{ line }, formats, queue);
+        }
+    };
 
-            std::string file{ line.substr(1, pathpos - 1) };
-            const std::string rest{ line.substr(pathpos + 2) };
-            std::istringstream is{ rest };
-            logfile::inode_type inode;  // NOLINT(cppcoreguidelines-init-variables)
-            unsigned long long pos;     // fpos<__mbstate_t> does not work in [is >>]  // NOLINT(cppcoreguidelines-init-variables,google-runtime-int)
+    // a record does not span a switch of the file
+    const auto control = [&ls, formats, &queue](const char * message) {
+        flush_record(ls, formats, queue);
+        queue.emplace(log_2_se(ls.path(), true, message));
+    };
 
-            is >> inode;
-            if (is.fail() || is.get() != ',') {
-                FILE_LOG(libs::log_level::ERROR) << "State file '" << path << "' has invalid node section: '" << rest << "'";
-                continue;
+    // lines written to a rotated file before the writer switched to the new one were not read yet
+    const auto drain = [&ls, &reader, &emit]() {
+        if (ls.fd() == -1) {
+            return;
+        }
+        try {
+            ls.set_position(reader.drain(ls.fd(), ls.get_position(), emit));
+        } catch (const std::exception & e) {
+            FILE_LOG(libs::log_level::ERROR) << "Stopped draining file '" << ls.path() << "': " << e.what();
+        }
+    };
+
+    if (ls.fd() == -1 || ls.down()) {
+        FILE_LOG(libs::log_level::DEBUG2) << "No stream: trying to set stream";
+        const int fd = open_logfile(ls.path());
+        if (fd == -1) {
+            FILE_LOG(libs::log_level::DEBUG) << "Can still not open file '" << ls.path() << "': " << ::strerror(errno) << ". Skipping this one";
+            return errno == ENOENT && !ls.config().pattern.empty() ? scan_result::REMOVED : result;
+        }
+        if (ls.fd() != -1) {
+            struct stat new_stat;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+            if (::fstat(fd, &new_stat) == 0 && new_stat.st_ino != ls.get_inode()) {
+                drain();
             }
+            ::close(ls.fd());
+        }
+        ls.fd() = fd;
+        FILE_LOG(libs::log_level::INFO) << "File '" << ls.path() << "' coming alive";
+        control("!File coming alive");
+        ls.down(false);
+        ls.timeout_triggered(false);
+        result = scan_result::REOPENED;
+    }
 
-            is >> pos;
-            if (is.fail()) {
-                FILE_LOG(libs::log_level::ERROR) << "State file '" << path << "' has invalid position section: '" << rest << "'";
-                continue;
+    struct stat tmp_stat;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    if (::stat(ls.path().c_str(), &tmp_stat)) {
+        const bool removed = errno == ENOENT && !ls.config().pattern.empty();
+        FILE_LOG(removed ? libs::log_level::INFO : libs::log_level::ERROR) << "Can not stat file '" << ls.path() << "': " << ::strerror(errno);
+        // keep the descriptor, to drain it once the file is back
+        if (ls.fd() != -1 && !ls.down()) {
+            try {
+                ls.set_position(reader.read(ls.fd(), ls.get_position(), emit));
+            } catch (const std::exception & e) {
+                FILE_LOG(libs::log_level::ERROR) << "Stopped reading from file '" << ls.path() << "': " << e.what();
             }
+        }
+        control("!File went down");
+        ls.down(true);
+        return removed ? scan_result::REMOVED : result;
+    }
 
-            FILE_LOG(libs::log_level::DEBUG) << "Extracted state: '" << file << "', '" << inode << "', '" << pos << "'";
+    /* checking inode */
+    if (tmp_stat.st_ino != ls.get_inode()) {
+        FILE_LOG(libs::log_level::INFO) << "Inode of file '" << ls.path() << "' changed";
+        if (result != scan_result::REOPENED) {
+            drain();
+            FILE_LOG(libs::log_level::DEBUG) << "Try to reset stream";
+            ::close(ls.fd());
+            ls.fd() = open_logfile(ls.path());
+        }
+        control("!File got replaced");
+
+        ls.set_inode(tmp_stat.st_ino);
+        if (ls.fd() == -1) {
+            FILE_LOG(libs::log_level::ERROR) << "Can not open file '" << ls.path() << "': " << ::strerror(errno) << ". Skipping this one";
+            control("!File went down");
+            ls.set_position(0);
+            return result;
+        }
+        result = scan_result::REOPENED;
 
-            state.emplace_back(std::move(file), inode, pos);
+        if (ls.get_fingerprint_length() > 0 && tmp_stat.st_size >= ls.get_position() && same_content(ls)) {
+            // e.g. copied back in place
+            FILE_LOG(libs::log_level::INFO) << "File '" << ls.path() << "' has the same content, continuing at " << ls.get_position();
+        } else {
+            ls.set_position(0);
+            ls.set_size(0);
+            ls.set_fingerprint(0, 0);
         }
     }
 
-    return state;
+    /* checking size */
+    if (tmp_stat.st_size == ls.get_size()) {
+        FILE_LOG(libs::log_level::DEBUG2) << "File '" << ls.path() << "' not changed. Early skip.";
+        return result;
+    }
+
+    // copytruncate: the file might have grown again beyond the old size before this check
+    if (tmp_stat.st_size < ls.get_size() || tmp_stat.st_size < ls.get_position() || !same_content(ls)) {
+        FILE_LOG(libs::log_level::INFO) << "File '" << ls.path() << "' truncated";
+        control("!File truncated");
+
+        ls.set_position(0);
+        ls.set_fingerprint(0, 0);
+    }
+    ls.set_size(tmp_stat.st_size);
+
+    FILE_LOG(libs::log_level::DEBUG) << "Reading from file...";
+    try {
+        ls.set_position(reader.read(ls.fd(), ls.get_position(), emit));
+    } catch (const std::exception & e) {
+        FILE_LOG(libs::log_level::ERROR) << "Stopped reading from file '" << ls.path() << "': " << e.what();
+    }
+    update_fingerprint(ls, tmp_stat.st_size);
+
+    return result;
 }
 
-static void save_state(const std::string & path, const std::vector<logfile> & log_states)
+[[nodiscard]] static int open_systemd_socket(const std::string & path, unsigned rcvbuf)
 {
-    FILE_LOG(libs::log_level::DEBUG) << "Saving state...";
-    {
-        const std::string state_file_tmp = path + ".tmp";
-        std::ofstream state_file{ state_file_tmp, std::ios::out | std::ios::trunc };
-        if (!state_file.is_open()) {
-            FILE_LOG(libs::log_level::ERROR) << "Can not open state file '" << state_file_tmp << "': " << ::strerror(errno);
-            FILE_LOG(libs::log_level::WARNING) << "State not saved to disk";
-        } else {
-            for (const auto & ls : log_states) {
-                state_file << "\"" << ls.path() << "\"," << ls.get_inode() << "," << ls.get_position() << "\n";
-            }
-            state_file.flush();
+    int socket = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socket == -1) {
+        throw libs::errno_exception{ "Can not create socket" };
+    }
+    libs::scope_guard close_socket{ [&socket]() {
+        if (socket != -1) {
+            ::close(socket);
+        }
+    } };
 
-            state_file.close();
+    // report datagrams dropped on a full receive queue
+    const int enable{ 1 };
+    if (::setsockopt(socket, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof enable) == -1) {
+        FILE_LOG(libs::log_level::DEBUG) << "Can not enable drop counter for systemd input: " << ::strerror(errno);
+    }
 
-            if (::rename(state_file_tmp.c_str(), path.c_str()) == -1) {
-                FILE_LOG(libs::log_level::ERROR) << "Can not rename '" << state_file_tmp << "' to '" << path << "': " << ::strerror(errno);
-                FILE_LOG(libs::log_level::WARNING) << "State not saved to disk";
-            }
+    if (rcvbuf > 0) {
+        const int size = static_cast<int>(std::min(rcvbuf, static_cast<unsigned>(std::numeric_limits<int>::max())));
+        // the forced variant is not limited by net.core.rmem_max
+        if (::setsockopt(socket, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof size) == -1 &&
+            ::setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &size, sizeof size) == -1) {
+            FILE_LOG(libs::log_level::WARNING) << "Can not set receive buffer size for systemd input: " << ::strerror(errno);
         }
     }
-    FILE_LOG(libs::log_level::DEBUG) << "State saved";
+
+    struct sockaddr_un local;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    local.sun_family = AF_UNIX;
+    constexpr size_t addr_length = sizeof(local.sun_path);
+    if (path.size() > (addr_length - 1)) {
+        throw libs::errno_exception{ "Bind address to long: " + std::to_string(path.size()) + "/" + std::to_string(addr_length - 1) };
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-array-to-pointer-decay,hicpp-no-array-decay)
+    ::strncpy(local.sun_path, path.c_str(), addr_length - 1);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-array-to-pointer-decay,hicpp-no-array-decay)
+    const size_t len = strlen(local.sun_path) + sizeof(local.sun_family);
+    if (::bind(socket, reinterpret_cast<struct sockaddr *>(&local), static_cast<unsigned>(len))) {  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        throw libs::errno_exception{ "Can not bind on '" + path + "'" };
+    }
+
+    const int ret = socket;
+    socket = -1;
+    return ret;
 }
 
-static void logfile_task(const logscan_config & cfg, libs::blocked_queue<libs::source_event> & queue, errorstack_t & es)
+// Read the pending datagrams of the systemd socket, at most SYSTEMD_BATCH to not starve the logfiles.
+static void read_systemd_socket(systemd_receiver & receiver, int socket, const format_extractor * formats, libs::blocked_queue<libs::source_event> & queue)
 {
-    FILE_LOG(libs::log_level::DEBUG) << "logfile-task started";
-    libs::scope_guard sg{ []() { FILE_LOG(libs::log_level::DEBUG) << "logfile-task stopped"; } };
+    const std::uint64_t dropped = receiver.dropped();
+
+    receiver.receive(socket, SYSTEMD_BATCH, [formats, &queue](std::string_view message) {
+        message = message.substr(0, message.find('\0'));
+        FILE_LOG(libs::log_level::DEBUG) << "systemd input Recvieved (" << message.size() << " bytes): '" << message << "'";
+
+        libs::source_event se;
+        if (message.size() >= 4 && message[0] == '<' && message[3] == '>') {
+            message.remove_prefix(4);  // skip leading <12>
+        }
+        se.message = message;
+        se.source_domain = "systemd_syslog";
+        se.source_program = "ctguard-logscan";
+        se.time_scanned = std::time(nullptr);
+        if (formats != nullptr) {
+            formats->extract(se);
+        }
+        queue.emplace(std::move(se));
+    });
+
+    if (receiver.dropped() != dropped) {
+        FILE_LOG(libs::log_level::WARNING) << "systemd input overrun: " << receiver.dropped() - dropped << " message(s) dropped by the kernel";
+    }
+}
+
+// Regular files currently matching pattern.
+static std::vector<std::string> expand_pattern(const std::string & pattern)
+{
+    ::glob_t g;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    const int ret = ::glob(pattern.c_str(), GLOB_MARK, nullptr, &g);
+    libs::scope_guard sg{ [&g]() { ::globfree(&g); } };
+    if (ret != 0) {
+        if (ret != GLOB_NOMATCH) {
+            FILE_LOG(libs::log_level::WARNING) << "Can not expand pattern '" << pattern << "'";
+        }
+        return {};
+    }
+
+    std::vector<std::string> paths;
+    for (std::size_t i = 0; i < g.gl_pathc; ++i) {
+        std::string path{ g.gl_pathv[i] };  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (!path.empty() && path.back() != '/') {
+            paths.push_back(std::move(path));
+        }
+    }
+    return paths;
+}
+
+// Open a file discovered at runtime, to be read from the beginning.
+static std::optional<logfile> attach_logfile(logfile_config lc)
+{
+    logfile state{ std::move(lc) };
+
+    state.fd() = open_logfile(state.path());
+    struct stat tmp_stat;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    if (state.fd() == -1 || ::fstat(state.fd(), &tmp_stat) == -1) {
+        FILE_LOG(libs::log_level::WARNING) << "Can not open discovered file '" << state.path() << "': " << ::strerror(errno);
+        return std::nullopt;
+    }
+
+    FILE_LOG(libs::log_level::INFO) << "Discovered file '" << state.path() << "' matching '" << state.config().pattern << "'";
+    state.set_inode(tmp_stat.st_ino);
+    state.set_size(0);  // nothing read yet
+    state.set_position(0);
+    state.update_time();
+
+    return state;
+}
+
+// Single epoll loop over the inotify descriptor and the systemd socket; changed logfiles are read by the reader pool.
+static void reactor_task(const logscan_config & cfg, const format_extractor * formats, libs::blocked_queue<libs::source_event> & queue, errorstack_t & es)
+{
+    FILE_LOG(libs::log_level::DEBUG) << "reactor-task started";
+    libs::scope_guard sg{ []() { FILE_LOG(libs::log_level::DEBUG) << "reactor-task stopped"; } };
 
     try {
         std::vector<logfile> log_states;
         log_states.reserve(cfg.log_files.size());
 
         FILE_LOG(libs::log_level::DEBUG) << "Retrieving saved state...";
-        const state_t saved_state{ get_state(cfg.state_file) };
+        state_store store{ cfg.state_file };
 
-        FILE_LOG(libs::log_level::DEBUG) << "Opening logfiles...";
+        file_watcher watcher{ cfg.inotify };
+
+        // watch the patterns before expanding them, to not miss files created meanwhile
+        std::vector<logfile_config> patterns;
+        std::vector<logfile_config> configs;
+        std::set<std::string> known;
         for (const logfile_config & lc : cfg.log_files) {
+            if (!is_glob_pattern(lc.path)) {
+                if (known.insert(lc.path).second) {
+                    configs.push_back(lc);
+                }
+                continue;
+            }
+
+            patterns.push_back(lc);
+            watcher.watch_pattern(lc.path);
+            for (auto & path : expand_pattern(lc.path)) {
+                if (known.insert(path).second) {
+                    logfile_config match{ lc };
+                    match.path = std::move(path);
+                    match.pattern = lc.path;
+                    configs.push_back(std::move(match));
+                }
+            }
+        }
+
+        FILE_LOG(libs::log_level::DEBUG) << "Opening logfiles...";
+        for (const logfile_config & lc : configs) {
             const std::string & lf = lc.path;
             logfile state{ lc };
 
-            state.fd() = ::open(lf.c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+            state.fd() = open_logfile(lf);
+            watcher.watch(lf);
             if (state.fd() == -1) {
                 if (errno == ENOENT) {
                     FILE_LOG(libs::log_level::WARNING) << "Can not open monitoring file '" << lf << "': " << ::strerror(errno);
@@ -164,48 +485,134 @@ static void logfile_task(const logscan_config & cfg, libs::blocked_queue<libs::s
             }
 
             // check for saved state
-            bool found_saved_state = false;
-            for (const auto & sstate : saved_state) {
-                if (std::get<0>(sstate) != state.path()) {
-                    continue;
-                }
-
-                found_saved_state = true;
-
-                const auto spos = std::get<2>(sstate);
-                const auto sinode = std::get<1>(sstate);
-
-                if (tmp_stat.st_ino != sinode) {
+            const auto saved = store.find(state.path());
+            if (saved.has_value()) {
+                state.set_fingerprint(saved->fingerprint, saved->fingerprint_length);
+                if (tmp_stat.st_ino != saved->inode) {
                     FILE_LOG(libs::log_level::INFO) << "Inode of file '" << lf << "' changed";
                     queue.emplace(log_2_se(lf, true, "!File got replaced"));
                     state.set_position(0);
+                    state.set_fingerprint(0, 0);
+                } else if (tmp_stat.st_size < static_cast<off_t>(saved->position) || !same_content(state)) {
+                    FILE_LOG(libs::log_level::INFO) << "File '" << lf << "' truncated";
+                    queue.emplace(log_2_se(lf, true, "!File truncated"));
+                    state.set_position(0);
+                    state.set_fingerprint(0, 0);
                 } else {
-                    state.set_position(spos);
+                    state.set_position(static_cast<std::streamoff>(saved->position));
                 }
             }
 
             state.set_inode(tmp_stat.st_ino);
             state.set_size(tmp_stat.st_size);
-            if (!found_saved_state) {
+            if (!saved.has_value()) {
                 FILE_LOG(libs::log_level::INFO) << "No state for monitoring file '" << lf << "' found";
                 state.set_position(tmp_stat.st_size);
             }
+            update_fingerprint(state, tmp_stat.st_size);
             state.update_time();
 
             log_states.emplace_back(std::move(state));
         }
+        store.retain(known);
+
+        int systemd_socket{ -1 };
+        if (cfg.systemd_input) {
+            if (::geteuid() != 0) {
+                FILE_LOG(libs::log_level::ERROR) << "systemd input must be root for access permission";
+            } else {
+                systemd_socket = open_systemd_socket(cfg.systemd_socket, cfg.systemd_rcvbuf);
+            }
+        }
+        std::optional<systemd_receiver> receiver;
+        if (systemd_socket != -1) {
+            receiver.emplace();
+        }
+        libs::scope_guard close_systemd_socket{ [&cfg, systemd_socket]() {
+            if (systemd_socket == -1) {
+                return;
+            }
+            ::close(systemd_socket);
+            if (::unlink(cfg.systemd_socket.c_str()) == -1) {
+                FILE_LOG(libs::log_level::ERROR) << "Can not unlink socket '" << cfg.systemd_socket << "': " << ::strerror(errno);
+            }
+        } };
 
-        if (log_states.empty()) {
+        if (log_states.empty() && patterns.empty() && systemd_socket == -1) {
             FILE_LOG(libs::log_level::ERROR) << "No active file(s) to monitor. Exiting...";
             return;
         }
 
-        FILE_LOG(libs::log_level::DEBUG) << "logfile scanner started";
+        const int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd == -1) {
+            throw libs::errno_exception{ "Can not create epoll instance" };
+        }
+        libs::scope_guard close_epoll{ [epoll_fd]() { ::close(epoll_fd); } };
+
+        for (const int fd : { watcher.fd(), systemd_socket }) {
+            if (fd == -1) {
+                continue;
+            }
+            struct ::epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+                throw libs::errno_exception{ "Can not add descriptor to epoll instance" };
+            }
+        }
 
-        unsigned int state_file_interval{ 0 };
+        unsigned threads = cfg.reader_threads != 0 ? cfg.reader_threads : std::thread::hardware_concurrency();
+        if (patterns.empty()) {
+            threads = std::min(threads, static_cast<unsigned>(log_states.size()));
+        }
+        threads = std::max(threads, 1U);
+        reader_pool pool{ threads };
+        std::vector<line_reader> readers(pool.size());
+        FILE_LOG(libs::log_level::DEBUG) << "logfile scanner started with " << pool.size() << " reader(s)";
+
+        std::vector<logfile *> pending;
+        std::vector<scan_result> results;
+        std::time_t last_state_save{ std::time(nullptr) };
+        std::time_t last_rescan{ std::time(nullptr) };
+        std::time_t last_drop_report{ std::time(nullptr) };
         while (RUNNING) {
             FILE_LOG(libs::log_level::DEBUG2) << "Loop begin...";
 
+            // inotify might miss changes, e.g. on network filesystems, and is not available for polling
+            bool rescan{ false };
+            if (std::time(nullptr) >= last_rescan + RESCAN_INTERVAL) {
+                rescan = true;
+                last_rescan = std::time(nullptr);
+            }
+
+            std::vector<std::pair<std::string, std::string>> discovered{ watcher.take_discovered() };
+            if (rescan) {
+                for (const auto & lc : patterns) {
+                    watcher.watch_pattern(lc.path);
+                    for (auto & path : expand_pattern(lc.path)) {
+                        discovered.emplace_back(lc.path, std::move(path));
+                    }
+                }
+            }
+            for (auto & [pattern, path] : discovered) {
+                if (!known.insert(path).second) {
+                    continue;
+                }
+
+                const auto pit = std::find_if(patterns.cbegin(), patterns.cend(), [&pattern = pattern](const logfile_config & lc) { return lc.path == pattern; });
+                logfile_config match{ *pit };
+                match.path = path;
+                match.pattern = pattern;
+                if (auto state = attach_logfile(std::move(match)); state.has_value()) {
+                    queue.emplace(log_2_se(state->path(), true, "!File discovered"));
+                    watcher.watch(state->path());
+                    log_states.emplace_back(std::move(*state));
+                } else {
+                    known.erase(path);
+                }
+            }
+
+            pending.clear();
             for (auto & ls : log_states) {
                 /* check for timeout warning */
                 if (ls.config().timeout_alert != 0 && !ls.timeout_triggered()) {
@@ -216,108 +623,100 @@ static void logfile_task(const logscan_config & cfg, libs::blocked_queue<libs::s
                     }
                 }
 
-                if (ls.fd() == -1 || ls.down()) {
-                    FILE_LOG(libs::log_level::DEBUG2) << "No stream: trying to set stream";
-                    ls.fd() = ::open(ls.path().c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
-                    if (ls.fd() == -1) {
-                        FILE_LOG(libs::log_level::DEBUG) << "Can still not open file '" << ls.path() << "': " << ::strerror(errno) << ". Skipping this one";
-                        continue;
-                    }
-                    FILE_LOG(libs::log_level::INFO) << "File '" << ls.path() << "' coming alive";
-                    queue.emplace(log_2_se(ls.path(), true, "!File coming alive"));
-                    ls.down(false);
-                    ls.timeout_triggered(false);
-                }
-
-                struct stat tmp_stat;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
-                if (::stat(ls.path().c_str(), &tmp_stat)) {
-                    FILE_LOG(libs::log_level::ERROR) << "Can not stat file '" << ls.path() << "': " << ::strerror(errno);
-                    queue.emplace(log_2_se(ls.path(), true, "!File went down"));
-                    ls.down(true);
-                    continue;
-                }
-
-                /* checking inode */
-                if (tmp_stat.st_ino != ls.get_inode()) {
-                    FILE_LOG(libs::log_level::INFO) << "Inode of file '" << ls.path() << "' changed";
-                    queue.emplace(log_2_se(ls.path(), true, "!File got replaced"));
-
-                    ls.set_inode(tmp_stat.st_ino);
-                    ls.set_position(0);
-                    FILE_LOG(libs::log_level::DEBUG) << "Try to reset stream";
-                    ::close(ls.fd());
-                    ls.fd() = ::open(ls.path().c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
-                    if (ls.fd() == -1) {
-                        FILE_LOG(libs::log_level::ERROR) << "Can not open file '" << ls.path() << "': " << ::strerror(errno) << ". Skipping this one";
-                        queue.emplace(log_2_se(ls.path(), true, "!File went down"));
-                        continue;
-                    }
-                }
-
-                /* checking size */
-                if (tmp_stat.st_size == ls.get_size()) {
-                    FILE_LOG(libs::log_level::DEBUG2) << "File '" << ls.path() << "' not changed. Early skip.";
-                    continue;
+                if (watcher.changed(ls.path()) || rescan || ls.fd() == -1 || ls.down()) {
+                    pending.push_back(&ls);
+                } else {
+                    FILE_LOG(libs::log_level::DEBUG2) << "No change reported for file '" << ls.path() << "'. Early skip.";
                 }
+            }
 
-                if (tmp_stat.st_size < ls.get_size()) {
-                    FILE_LOG(libs::log_level::INFO) << "File '" << ls.path() << "' truncated";
-                    queue.emplace(log_2_se(ls.path(), true, "!File truncated"));
-
-                    ls.set_position(0);
+            // every file is scanned by one reader, keeping its lines in order
+            results.assign(pending.size(), scan_result::UNCHANGED);
+            pool.run(pending.size(), [&pending, &results, &readers, formats, &queue](std::size_t job, unsigned worker) {
+                results[job] = scan_logfile(*pending[job], readers[worker], formats, queue);
+            });
+            bool removed{ false };
+            for (std::size_t i = 0; i < pending.size(); ++i) {
+                if (results[i] == scan_result::REOPENED) {
+                    watcher.watch(pending[i]->path());
+                } else if (results[i] == scan_result::REMOVED) {
+                    FILE_LOG(libs::log_level::INFO) << "Detaching removed file '" << pending[i]->path() << "'";
+                    send_repeats(*pending[i], repeat_folder::clock::time_point::max(), formats, queue);
+                    report_dropped(*pending[i], true);
+                    watcher.unwatch(pending[i]->path());
+                    store.remove(pending[i]->path());
+                    known.erase(pending[i]->path());
+                    removed = true;
                 }
-                ls.set_size(tmp_stat.st_size);
+            }
+            if (removed) {
+                log_states.erase(std::remove_if(log_states.begin(), log_states.end(), [&known](const logfile & ls) { return known.count(ls.path()) == 0; }),
+                                 log_states.end());
+            }
 
-                FILE_LOG(libs::log_level::DEBUG) << "Reading from stream...";
-                std::ifstream st{ ls.path() };
-                if (!st.is_open()) {
-                    FILE_LOG(libs::log_level::ERROR) << "Can not open stream for file '" << ls.path() << "': " << ::strerror(errno);
-                    continue;
-                }
+            if (!log_states.empty() &&
+                std::time(nullptr) >= last_state_save + static_cast<std::time_t>(cfg.state_file_interval)) {
+                save_state(store, log_states);
+                last_state_save = std::time(nullptr);
+            }
 
-                st.seekg(ls.get_position());
-                if (!st) {
-                    FILE_LOG(libs::log_level::ERROR) << "Can not seek to last position (" << ls.get_position() << ") in file '" << ls.path()
-                                                     << "': " << ::strerror(errno);
-                    continue;
+            if (std::time(nullptr) >= last_drop_report + DROP_REPORT_INTERVAL) {
+                for (auto & ls : log_states) {
+                    report_dropped(ls, false);
                 }
+                last_drop_report = std::time(nullptr);
+            }
 
-                std::string line;
-                while (st) {
-                    std::getline(st, line);
-
-                    if (!line.empty()) {
-                        ls.set_position(st.tellg());
-
-                        FILE_LOG(libs::log_level::DEBUG) << "Line got from '" << ls.path() << "': '" << line << "'";
-
-                        ls.update_time();
-                        ls.timeout_triggered(false);
-                        queue.emplace(log_2_se(ls.path(), false, line));
-
+            // pass on multi-line records without further lines in time and summaries of repeated lines, and wake up for the next one
+            std::chrono::milliseconds timeout{ std::chrono::seconds{ cfg.check_interval } };
+            const auto now = multiline_assembler::clock::now();
+            for (auto & ls : log_states) {
+                if (const auto deadline = ls.multiline().has_value() ? ls.multiline()->deadline() : std::nullopt; deadline.has_value()) {
+                    if (*deadline <= now) {
+                        flush_record(ls, formats, queue);
                     } else {
-                        FILE_LOG(libs::log_level::DEBUG) << "No input from '" << ls.path() << "'";
+                        timeout = std::min(timeout, std::chrono::ceil<std::chrono::milliseconds>(*deadline - now));
                     }
                 }
-                if (!st.eof()) {
-                    FILE_LOG(libs::log_level::ERROR) << "File '" << ls.path() << "' not eof";
-                }
-                if (st.bad()) {
-                    FILE_LOG(libs::log_level::ERROR) << "Stopped reading from file '" << ls.path() << "' due to bad";
+                if (const auto deadline = ls.repeats().has_value() ? ls.repeats()->deadline() : std::nullopt; deadline.has_value()) {
+                    if (*deadline <= now) {
+                        send_repeats(ls, now, formats, queue);
+                    } else {
+                        timeout = std::min(timeout, std::chrono::ceil<std::chrono::milliseconds>(*deadline - now));
+                    }
                 }
             }
 
-            state_file_interval++;
-            if (state_file_interval > cfg.state_file_interval) {
-                save_state(cfg.state_file, log_states);
-                state_file_interval = 0;
+            FILE_LOG(libs::log_level::DEBUG2) << "Waiting for changes up to " << timeout.count() << " milliseconds ...";
+            std::array<struct ::epoll_event, 4> events;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+            const int n = ::epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), static_cast<int>(timeout.count()));
+            if (n == -1 && errno != EINTR) {
+                throw libs::errno_exception{ "Can not wait for events" };
             }
+            for (int i = 0; i < n; ++i) {
+                const int fd = events[static_cast<std::size_t>(i)].data.fd;  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+                if (fd == watcher.fd()) {
+                    watcher.process_events();
+                } else if (fd == systemd_socket) {
+                    read_systemd_socket(*receiver, systemd_socket, formats, queue);
+                }
+            }
+        }
+
+        for (auto & ls : log_states) {
+            flush_record(ls, formats, queue);
+            send_repeats(ls, repeat_folder::clock::time_point::max(), formats, queue);
+            report_dropped(ls, true);
+        }
 
-            FILE_LOG(libs::log_level::DEBUG2) << "Waiting for " << cfg.check_interval << " seconds ...";
-            sleep(cfg.check_interval);
+        if (!log_states.empty()) {
+            save_state(store, log_states);
         }
 
-        save_state(cfg.state_file, log_states);
+        if (receiver.has_value()) {
+            FILE_LOG(libs::log_level::INFO) << "systemd input: " << receiver->received() << " message(s) received, " << receiver->truncated() << " truncated, "
+                                            << receiver->dropped() << " dropped";
+        }
 
     } catch (...) {
         std::lock_guard lg{ es.first };
@@ -392,107 +791,6 @@ static void output_task(libs::blocked_queue<libs::source_event> & queue, eventsi
     }
 }
 
-static void systemd_task(const logscan_config & cfg, libs::blocked_queue<libs::source_event> & queue, errorstack_t & es)
-{
-    FILE_LOG(libs::log_level::DEBUG) << "systemd-task started";
-    libs::scope_guard sg{ []() { FILE_LOG(libs::log_level::DEBUG) << "systemd-task stopped"; } };
-
-    if (!cfg.systemd_input) {
-        FILE_LOG(libs::log_level::DEBUG) << "systemd input not enabled";
-        return;
-    }
-
-    if (::geteuid() != 0) {
-        FILE_LOG(libs::log_level::ERROR) << "systemd-task must be root for access permission";
-        return;
-    }
-
-    try {
-        int socket = ::socket(AF_UNIX, SOCK_DGRAM, 0);
-        if (socket == -1) {
-            throw libs::errno_exception{ "Can not create socket" };
-        }
-        libs::scope_guard close_socket{ [&socket]() { ::close(socket); } };
-
-        struct sockaddr_un local;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
-        local.sun_family = AF_UNIX;
-        constexpr size_t addr_length = sizeof(local.sun_path);
-        if (cfg.systemd_socket.size() > (addr_length - 1)) {
-            throw libs::errno_exception{ "Bind address to long: " + std::to_string(cfg.systemd_socket.size()) + "/" + std::to_string(addr_length - 1) };
-        }
-        const struct timeval tv
-        {
-            1, 0
-        };  // 1s
-        if (::setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv) == -1) {
-            throw libs::errno_exception{ "Can not setsockopt()" };
-        }
-        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-array-to-pointer-decay,hicpp-no-array-decay)
-        ::strncpy(local.sun_path, cfg.systemd_socket.c_str(), addr_length - 1);
-        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-array-to-pointer-decay,hicpp-no-array-decay)
-        const size_t len = strlen(local.sun_path) + sizeof(local.sun_family);
-        if (::bind(socket, reinterpret_cast<struct sockaddr *>(&local), static_cast<unsigned>(len))) {  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-            throw libs::errno_exception{ "Can not bind on '" + cfg.systemd_socket + "'" };
-        }
-        libs::scope_guard unlink_socket{ [&cfg]() {
-            if (::unlink(cfg.systemd_socket.c_str()) == -1) {
-                FILE_LOG(libs::log_level::ERROR) << "Can not unlink socket '" << cfg.systemd_socket << "': " << ::strerror(errno);
-            }
-        } };
-
-        while (RUNNING) {
-            bool done = false;
-            FILE_LOG(libs::log_level::DEBUG2) << "systemd-task waiting for connection...";
-
-            do {
-                std::array<char, 512> buffer;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
-                const ssize_t n = ::recv(socket, buffer.data(), buffer.size(), 0);
-                if (n <= 0) {
-                    if (n < 0) {
-                        if (errno == EAGAIN) {
-                            FILE_LOG(libs::log_level::DEBUG2) << "systemd-task Recv timeout";
-                        } else if (errno == EINTR) {
-                            FILE_LOG(libs::log_level::DEBUG) << "systemd-task Recv abort: " << ::strerror(errno);
-                        } else {
-                            FILE_LOG(libs::log_level::WARNING) << "systemd-task Recv error: " << ::strerror(errno);
-                        }
-                        break;
-                    }
-                    done = true;
-                } else if (static_cast<size_t>(n) >= buffer.size() - 1) {
-                    FILE_LOG(libs::log_level::WARNING) << "systemd-task Recv buffer to short: " << n << "/" << buffer.size();
-                }
-
-                if (static_cast<std::size_t>(n) >= buffer.size()) {
-                    buffer[buffer.size() - 1] = '\0';
-                } else {
-                    buffer[static_cast<std::size_t>(n)] = '\0';  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
-                }
-
-                FILE_LOG(libs::log_level::DEBUG) << "systemd-task Recvieved (" << n << " bytes): '" << buffer.data() << "'";
-
-                {
-                    libs::source_event se;
-                    if (buffer[0] == '<' && buffer[3] == '>') {
-                        se.message = buffer.data() + 4;  // skip leading <12>
-                    } else {
-                        se.message = buffer.data();
-                    }
-                    se.source_domain = "systemd_syslog";
-                    se.source_program = "ctguard-logscan";
-                    se.time_scanned = std::time(nullptr);
-                    queue.emplace(std::move(se));
-                }
-
-            } while (!done);
-        }
-
-    } catch (...) {
-        std::lock_guard lg{ es.first };
-        es.second.push(std::current_exception());
-    }
-}
-
 void daemon(const logscan_config & cfg, bool unit_test)
 {
     UNIT_TEST = unit_test;
@@ -502,12 +800,23 @@ void daemon(const logscan_config & cfg, bool unit_test)
 
     eventsink es{ cfg.output_path, cfg.output_kind, UNIT_TEST };
 
+    std::optional<format_extractor> formats;
+    if (!cfg.formats_file.empty()) {
+        try {
+            libs::check_cfg_file_perms(cfg.formats_file);
+            formats.emplace(cfg.formats_file);
+        } catch (const std::exception & e) {
+            throw libs::lib_exception{ "Can not load formats file '" + cfg.formats_file + "': " + e.what() };
+        }
+        FILE_LOG(libs::log_level::INFO) << "Extracting fields by " << formats->size() << " formats";
+    }
+    const format_extractor * formats_ptr = formats.has_value() ? &*formats : nullptr;
+
     libs::scope_guard endmsg{ []() { FILE_LOG(libs::log_level::INFO) << "ctguard-logscan stopped"; } };
 
     FILE_LOG(libs::log_level::DEBUG) << "starting threads...";
 
-    std::thread logfile_thread{ logfile_task, std::cref(cfg), std::ref(event_queue), std::ref(errorstack) };
-    std::thread systemd_thread{ systemd_task, std::cref(cfg), std::ref(event_queue), std::ref(errorstack) };
+    std::thread reactor_thread{ reactor_task, std::cref(cfg), formats_ptr, std::ref(event_queue), std::ref(errorstack) };
     std::thread output_thread{ output_task, std::ref(event_queue), std::ref(es), std::ref(errorstack) };
 
     FILE_LOG(libs::log_level::DEBUG) << "threads started";
@@ -572,16 +881,16 @@ void daemon(const logscan_config & cfg, bool unit_test)
     FILE_LOG(libs::log_level::INFO) << "ctguard-logscan shutting down...";
     event_queue.emplace(log_2_se("daemon", true, "ctguard-logscan shutting down..."));
     RUNNING = false;
+
+    FILE_LOG(libs::log_level::DEBUG) << "waiting for threads...";
+    // the reactor flushes pending records and repeat summaries on shutdown, so stop the output only afterwards
+    reactor_thread.join();
     {
         libs::source_event se;
         se.control_message = true;
         se.message = "!KILL";
         event_queue.emplace(std::move(se));
     }
-
-    FILE_LOG(libs::log_level::DEBUG) << "waiting for threads...";
-    logfile_thread.join();
-    systemd_thread.join();
     output_thread.join();
     FILE_LOG(libs::log_level::DEBUG) << "threads finished";
 }
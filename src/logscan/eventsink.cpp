@@ -3,7 +3,9 @@
 #include <unistd.h>
 
 #include <cereal/archives/binary.hpp>
+#include <cereal/types/map.hpp>
 #include <cereal/types/memory.hpp>
+#include <cereal/types/string.hpp>
 
 #include "../libs/errnoexception.hpp"
 
@@ -20,7 +22,11 @@ file_sink::file_sink(const std::string & path) : m_out{ path, std::ios::app }
 
 void file_sink::send(libs::source_event se)
 {
-    m_out << " [" << se.source_domain << "] : " << se.message << "\n";
+    m_out << " [" << se.source_domain << "] : " << se.message;
+    if (se.repeats > 0) {
+        m_out << " (repeated " << se.repeats << " times)";
+    }
+    m_out << "\n";
     m_out.flush();
 }
 
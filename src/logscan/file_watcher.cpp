@@ -0,0 +1,209 @@
+#include "file_watcher.hpp"
+
+#include <fnmatch.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include "../libs/errnoexception.hpp"
+#include "../libs/logger.hpp"
+
+namespace ctguard::logscan {
+
+static constexpr uint32_t FILE_EVENTS{ IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF };
+static constexpr uint32_t DIR_EVENTS{ IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_ONLYDIR };
+
+file_watcher::file_watcher(bool enable)
+{
+    if (!enable) {
+        FILE_LOG(libs::log_level::INFO) << "Polling logfiles";
+        return;
+    }
+
+    m_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd == -1) {
+        FILE_LOG(libs::log_level::WARNING) << "Can not initialize inotify, falling back to polling: " << ::strerror(errno);
+    }
+}
+
+file_watcher::~file_watcher()
+{
+    if (m_fd != -1) {
+        ::close(m_fd);
+    }
+}
+
+static std::pair<std::string, std::string> split_path(const std::string & path)
+{
+    const auto slash = path.rfind('/');
+    if (slash == std::string::npos) {
+        return { ".", path };
+    }
+    return { slash == 0 ? "/" : path.substr(0, slash), path.substr(slash + 1) };
+}
+
+int file_watcher::add_dir_watch(const std::string & dir)
+{
+    const int wd = ::inotify_add_watch(m_fd, dir.c_str(), DIR_EVENTS);
+    if (wd == -1) {
+        FILE_LOG(libs::log_level::WARNING) << "Can not watch directory '" << dir << "': " << ::strerror(errno);
+    }
+    return wd;
+}
+
+void file_watcher::watch(const std::string & path)
+{
+    if (!active()) {
+        return;
+    }
+
+    auto & wds = m_paths.try_emplace(path, -1, -1).first->second;
+
+    // the directory reports the file being created, moved or deleted
+    if (wds.second == -1) {
+        const auto [dir, base] = split_path(path);
+        if (const int wd = add_dir_watch(dir); wd != -1) {
+            m_dir_watches[wd].files[base] = path;
+            wds.second = wd;
+        }
+    }
+
+    const int wd = ::inotify_add_watch(m_fd, path.c_str(), FILE_EVENTS);
+    if (wd != wds.first && wds.first != -1) {
+        // still watching a replaced file
+        ::inotify_rm_watch(m_fd, wds.first);
+        m_file_watches.erase(wds.first);
+    }
+    if (wd == -1) {
+        FILE_LOG(libs::log_level::DEBUG) << "Can not watch file '" << path << "', polling it: " << ::strerror(errno);
+    } else {
+        m_file_watches[wd] = path;
+    }
+    wds.first = wd;
+
+    m_changed.insert(path);
+}
+
+void file_watcher::unwatch(const std::string & path)
+{
+    const auto it = m_paths.find(path);
+    if (it == m_paths.end()) {
+        return;
+    }
+
+    if (const int wd = it->second.first; wd != -1) {
+        ::inotify_rm_watch(m_fd, wd);
+        m_file_watches.erase(wd);
+    }
+    if (const auto dit = m_dir_watches.find(it->second.second); dit != m_dir_watches.end()) {
+        dit->second.files.erase(split_path(path).second);
+    }
+
+    m_paths.erase(it);
+    m_changed.erase(path);
+}
+
+void file_watcher::watch_pattern(const std::string & pattern)
+{
+    if (!active()) {
+        return;
+    }
+
+    const auto [dir, base] = split_path(pattern);
+    if (const int wd = add_dir_watch(dir); wd != -1) {
+        m_dir_watches[wd].patterns.insert(pattern);
+    }
+}
+
+std::vector<std::pair<std::string, std::string>> file_watcher::take_discovered()
+{
+    std::vector<std::pair<std::string, std::string>> discovered;
+    discovered.swap(m_discovered);
+    return discovered;
+}
+
+bool file_watcher::changed(const std::string & path)
+{
+    if (!active()) {
+        return true;
+    }
+
+    const auto it = m_paths.find(path);
+    if (it == m_paths.end() || it->second.first == -1) {
+        return true;
+    }
+
+    return m_changed.erase(path) > 0;
+}
+
+void file_watcher::process_events()
+{
+    std::array<char, 4096> buffer;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+
+    for (;;) {
+        const ssize_t len = ::read(m_fd, buffer.data(), buffer.size());
+        if (len == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                return;
+            }
+            throw libs::errno_exception{ "Can not read inotify events" };
+        }
+
+        for (std::size_t off = 0; off < static_cast<std::size_t>(len);) {
+            struct ::inotify_event event;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+            std::memcpy(&event, buffer.data() + off, sizeof event);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            const char * name = buffer.data() + off + sizeof event;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            off += sizeof event + event.len;
+
+            if (event.mask & IN_Q_OVERFLOW) {
+                FILE_LOG(libs::log_level::DEBUG) << "inotify event queue overflow";
+                for (const auto & p : m_paths) {
+                    m_changed.insert(p.first);
+                }
+                continue;
+            }
+
+            if (const auto fit = m_file_watches.find(event.wd); fit != m_file_watches.end()) {
+                m_changed.insert(fit->second);
+                if (event.mask & IN_IGNORED) {
+                    // file deleted: poll until watched again
+                    m_paths[fit->second].first = -1;
+                    m_file_watches.erase(fit);
+                }
+                continue;
+            }
+
+            if (const auto dit = m_dir_watches.find(event.wd); dit != m_dir_watches.end()) {
+                if (event.mask & IN_IGNORED) {
+                    for (const auto & p : dit->second.files) {
+                        m_paths[p.second].second = -1;
+                        m_changed.insert(p.second);
+                    }
+                    m_dir_watches.erase(dit);
+                } else if (event.len > 0) {
+                    if (const auto pit = dit->second.files.find(name); pit != dit->second.files.end()) {
+                        m_changed.insert(pit->second);
+                    } else if ((event.mask & (IN_CREATE | IN_MOVED_TO)) && !(event.mask & IN_ISDIR)) {
+                        for (const auto & pattern : dit->second.patterns) {
+                            const auto slash = pattern.rfind('/');
+                            const char * base = slash == std::string::npos ? pattern.c_str() : pattern.c_str() + slash + 1;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                            if (::fnmatch(base, name, FNM_PERIOD) == 0) {
+                                m_discovered.emplace_back(pattern, (slash == std::string::npos ? "" : pattern.substr(0, slash + 1)) + name);
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+} /* namespace ctguard::logscan */
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ctguard::logscan {
+
+// Reports changes of logfiles via inotify on the files and their directories, and new files matching a pattern.
+// Without inotify support every file counts as changed and no files are discovered.
+class file_watcher
+{
+  public:
+    explicit file_watcher(bool enable);
+    ~file_watcher();
+
+    file_watcher(const file_watcher &) = delete;
+    file_watcher & operator=(const file_watcher &) = delete;
+    file_watcher(file_watcher &&) = delete;
+    file_watcher & operator=(file_watcher &&) = delete;
+
+    [[nodiscard]] bool active() const noexcept { return m_fd != -1; }
+
+    // Non-blocking inotify descriptor to wait on, -1 if not active.
+    [[nodiscard]] int fd() const noexcept { return m_fd; }
+
+    // (Re)watch the file currently at path, e.g. after it was opened again.
+    void watch(const std::string & path);
+
+    // Stop watching path, e.g. after it got removed.
+    void unwatch(const std::string & path);
+
+    // Report files created in the directory of pattern whose name matches the pattern; only the file name might contain wildcards.
+    void watch_pattern(const std::string & pattern);
+
+    // Files discovered since the last call, as pattern and path.
+    [[nodiscard]] std::vector<std::pair<std::string, std::string>> take_discovered();
+
+    // Process the pending events of fd().
+    void process_events();
+
+    // Whether path might have changed since the last call; true for files that can not be watched.
+    [[nodiscard]] bool changed(const std::string & path);
+
+  private:
+    struct dir_watch
+    {
+        std::map<std::string, std::string> files;  // basename -> path
+        std::set<std::string> patterns;
+    };
+
+    int m_fd{ -1 };
+    std::map<int, std::string> m_file_watches;           // watch descriptor -> path
+    std::map<int, dir_watch> m_dir_watches;              // watch descriptor -> watched entries
+    std::map<std::string, std::pair<int, int>> m_paths;  // path -> file and directory watch descriptor
+    std::set<std::string> m_changed;
+    std::vector<std::pair<std::string, std::string>> m_discovered;
+
+    [[nodiscard]] int add_dir_watch(const std::string & dir);
+};
+
+} /* namespace ctguard::logscan */
@@ -0,0 +1,52 @@
+#include "formats.hpp"
+
+#include "../libs/libexception.hpp"
+#include "../libs/xml/XMLDocument.hpp"
+
+namespace ctguard::logscan {
+
+format_extractor::format_extractor(const std::string & path)
+{
+    const libs::xml::XMLDocument doc{ libs::xml::XMLDocument::load_file(path) };
+    const libs::xml::XMLNodeView & root = doc.root();
+
+    if (root.name() != "rule_group") {
+        throw libs::lib_exception{ "Expected root 'rule_group' node, got '" + std::string{ root.name() } + "'" };
+    }
+
+    for (auto const & node : root.children()) {
+        if (node.name() != "format") {
+            continue;
+        }
+
+        m_formats.emplace_back(libs::parse_log_format(node));
+    }
+}
+
+void format_extractor::extract(libs::source_event & se) const
+{
+    const std::string_view input{ libs::format_input(se.message) };
+
+    for (const auto & f : m_formats) {
+        libs::format_match match;
+        try {
+            if (!std::regex_match(input.cbegin(), input.cend(), match, f.reg)) {
+                continue;
+            }
+        } catch (const std::regex_error &) {
+            // let research evaluate the line itself
+            return;
+        }
+
+        for (std::size_t i = 1; i < match.size(); ++i) {
+            se.fields[f.fields[i - 1]] = match[i];
+        }
+        se.format = f.name;
+
+        return;
+    }
+
+    se.format = "unknown";
+}
+
+} /* namespace ctguard::logscan */
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../libs/log_format.hpp"
+#include "../libs/source_event.hpp"
+
+namespace ctguard::logscan {
+
+// The <format> definitions of a research rules file, to extract the fields of log lines before sending them.
+// Other nodes of the rules file are ignored.
+class format_extractor
+{
+  public:
+    // Load the formats from the rules file at path; throws on error.
+    explicit format_extractor(const std::string & path);
+
+    // Set the format and fields of se by the first matching format, or the format 'unknown'.
+    void extract(libs::source_event & se) const;
+
+    [[nodiscard]] std::size_t size() const noexcept { return m_formats.size(); }
+
+  private:
+    std::vector<libs::log_format> m_formats;
+};
+
+} /* namespace ctguard::logscan */
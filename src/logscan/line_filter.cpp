@@ -0,0 +1,43 @@
+#include "line_filter.hpp"
+
+#include <algorithm>
+
+namespace ctguard::logscan {
+
+static std::vector<std::regex> compile(const std::vector<std::string> & sources)
+{
+    std::vector<std::regex> regexes;
+    regexes.reserve(sources.size());
+    for (const auto & s : sources) {
+        regexes.emplace_back(s, std::regex::ECMAScript | std::regex::nosubs | std::regex::optimize);
+    }
+    return regexes;
+}
+
+line_filter::line_filter(const line_filter_config & cfg)
+  : m_drop{ cfg.drop, compile(cfg.drop_regex) }, m_keep{ cfg.keep, compile(cfg.keep_regex) }
+{}
+
+bool line_filter::patterns::match(std::string_view line) const
+{
+    // literals first, they are cheap
+    if (std::any_of(literals.cbegin(), literals.cend(), [line](const std::string & l) { return line.find(l) != std::string_view::npos; })) {
+        return true;
+    }
+
+    return std::any_of(regexes.cbegin(), regexes.cend(), [line](const std::regex & re) {
+        return std::regex_search(line.data(), line.data() + line.size(), re);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    });
+}
+
+bool line_filter::pass(std::string_view line)
+{
+    if (!m_drop.match(line) || m_keep.match(line)) {
+        return true;
+    }
+
+    m_dropped++;
+    return false;
+}
+
+} /* namespace ctguard::logscan */
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.hpp"
+
+namespace ctguard::logscan {
+
+// Drops known noise of one logfile before it is sent: lines matching a drop pattern and no keep pattern.
+class line_filter
+{
+  public:
+    explicit line_filter(const line_filter_config & cfg);
+
+    // Whether line is to be sent; counts the dropped ones.
+    [[nodiscard]] bool pass(std::string_view line);
+
+    [[nodiscard]] std::uint64_t dropped() const noexcept { return m_dropped; }
+
+    // Whether lines were dropped since the last call, for periodic reports.
+    [[nodiscard]] bool take_changed() noexcept
+    {
+        const bool changed = m_dropped != m_reported;
+        m_reported = m_dropped;
+        return changed;
+    }
+
+  private:
+    struct patterns
+    {
+        std::vector<std::string> literals;
+        std::vector<std::regex> regexes;
+
+        [[nodiscard]] bool match(std::string_view line) const;
+    };
+
+    patterns m_drop;
+    patterns m_keep;
+    std::uint64_t m_dropped{ 0 };
+    std::uint64_t m_reported{ 0 };
+};
+
+} /* namespace ctguard::logscan */
@@ -0,0 +1,109 @@
+#include "line_reader.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include "../libs/errnoexception.hpp"
+#include "../libs/hash.hpp"
+
+namespace ctguard::logscan {
+
+off_t line_reader::read(int fd, off_t offset, const std::function<void(std::string_view)> & cb)
+{
+    const off_t start = offset;
+    std::size_t used{ 0 };
+
+    for (;;) {
+        const ssize_t ret = ::pread(fd, m_buffer.data() + used, m_buffer.size() - used, offset + static_cast<off_t>(used));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw libs::errno_exception{ "Can not read at offset " + std::to_string(offset + static_cast<off_t>(used)) };
+        }
+        if (ret == 0) {
+            break;
+        }
+        used += static_cast<std::size_t>(ret);
+
+        const char * begin = m_buffer.data();
+        const char * const end = m_buffer.data() + used;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        while (const char * nl = static_cast<const char *>(::memchr(begin, '\n', static_cast<std::size_t>(end - begin)))) {
+            if (nl != begin) {
+                cb(std::string_view{ begin, static_cast<std::size_t>(nl - begin) });
+            }
+            begin = nl + 1;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+
+        auto done = static_cast<std::size_t>(begin - m_buffer.data());
+        if (done == 0 && used == m_buffer.size()) {
+            // no line end in a full buffer
+            cb(std::string_view{ m_buffer.data(), used });
+            done = used;
+        }
+
+        offset += static_cast<off_t>(done);
+        used -= done;
+        ::memmove(m_buffer.data(), begin, used);
+    }
+
+    // the consumed data is not needed anymore, except the start for the fingerprint
+    if (const off_t from = std::max(start, static_cast<off_t>(FINGERPRINT_SIZE)); offset > from) {
+        ::posix_fadvise(fd, from, offset - from, POSIX_FADV_DONTNEED);
+    }
+
+    return offset;
+}
+
+off_t line_reader::drain(int fd, off_t offset, const std::function<void(std::string_view)> & cb)
+{
+    offset = read(fd, offset, cb);
+
+    // the rest is shorter than the buffer, otherwise read would have split it
+    for (;;) {
+        const ssize_t ret = ::pread(fd, m_buffer.data(), m_buffer.size(), offset);
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw libs::errno_exception{ "Can not read at offset " + std::to_string(offset) };
+        }
+        if (ret > 0) {
+            cb(std::string_view{ m_buffer.data(), static_cast<std::size_t>(ret) });
+            offset += ret;
+        }
+        return offset;
+    }
+}
+
+std::optional<std::uint64_t> line_reader::fingerprint(int fd, std::size_t length)
+{
+    std::array<unsigned char, FINGERPRINT_SIZE> buffer;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    length = std::min(length, buffer.size());
+
+    std::size_t got{ 0 };
+    while (got < length) {
+        const ssize_t ret = ::pread(fd, buffer.data() + got, length - got, static_cast<off_t>(got));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return std::nullopt;
+        }
+        if (ret == 0) {
+            return std::nullopt;
+        }
+        got += static_cast<std::size_t>(ret);
+    }
+
+    return libs::fnv1a(buffer.data(), length);
+}
+
+void line_reader::advise_sequential(int fd) noexcept { ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL); }
+
+} /* namespace ctguard::logscan */
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace ctguard::logscan {
+
+// Reads lines from a file descriptor in large chunks into a reusable buffer.
+class line_reader
+{
+  public:
+    static constexpr std::size_t CHUNK_SIZE{ 256 * 1024 };
+    static constexpr std::size_t FINGERPRINT_SIZE{ 256 };
+
+    line_reader() : m_buffer(CHUNK_SIZE) {}
+
+    // Read all complete lines from fd starting at offset and pass the non-empty ones to cb.
+    // Returns the offset after the last complete line; a trailing partial line is left for the next call.
+    // Lines longer than CHUNK_SIZE are passed on in pieces.
+    off_t read(int fd, off_t offset, const std::function<void(std::string_view)> & cb);
+
+    // Like read, but also passes on a trailing partial line; for files not written to anymore, e.g. after a rotation.
+    off_t drain(int fd, off_t offset, const std::function<void(std::string_view)> & cb);
+
+    // Hash of the first length bytes of fd, to recognize its content; nullopt if the file is shorter or can not be read.
+    [[nodiscard]] static std::optional<std::uint64_t> fingerprint(int fd, std::size_t length);
+
+    // Hint the kernel, that fd is read sequentially.
+    static void advise_sequential(int fd) noexcept;
+
+  private:
+    std::vector<char> m_buffer;
+};
+
+} /* namespace ctguard::logscan */
@@ -4,12 +4,17 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <cstdint>
 #include <exception>
 #include <fstream>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "config.hpp"
+#include "line_filter.hpp"
+#include "multiline.hpp"
+#include "repeat_folder.hpp"
 
 namespace ctguard::logscan {
 
@@ -20,7 +25,18 @@ class logfile
     using inode_type = decltype(std::declval<struct stat>().st_ino);
     using size_type = decltype(std::declval<struct stat>().st_size);
 
-    explicit logfile(logfile_config config) : m_config{ std::move(config) } {}
+    explicit logfile(logfile_config config) : m_config{ std::move(config) }
+    {
+        if (m_config.multiline.mode != multiline_config::mode_t::NONE) {
+            m_multiline.emplace(m_config.multiline);
+        }
+        if (m_config.dedup_window != 0) {
+            m_repeats.emplace(std::chrono::seconds{ m_config.dedup_window });
+        }
+        if (!m_config.filter.empty()) {
+            m_filter.emplace(m_config.filter);
+        }
+    }
 
     ~logfile() noexcept
     {
@@ -33,11 +49,36 @@ class logfile
     logfile & operator=(const logfile &) = delete;
     logfile(logfile && other) noexcept
       : m_config{ std::move(other.m_config) }, m_fd{ other.m_fd },
-        m_position{ other.m_position }, m_inode{ other.m_inode }, m_size{ other.m_size }, m_down{ other.m_down }, m_last_updated{ other.m_last_updated }
+        m_position{ other.m_position }, m_inode{ other.m_inode }, m_size{ other.m_size }, m_fingerprint{ other.m_fingerprint },
+        m_fingerprint_length{ other.m_fingerprint_length }, m_multiline{ std::move(other.m_multiline) },
+        m_repeats{ std::move(other.m_repeats) }, m_filter{ std::move(other.m_filter) }, m_down{ other.m_down },
+        m_last_updated{ other.m_last_updated }, m_timeout_triggered{ other.m_timeout_triggered }
     {
         other.m_fd = -1;
     }
-    logfile & operator=(logfile &&) = delete;
+    logfile & operator=(logfile && other) noexcept
+    {
+        if (this != &other) {
+            if (m_fd != -1) {
+                ::close(m_fd);
+            }
+            m_config = std::move(other.m_config);
+            m_fd = other.m_fd;
+            m_position = other.m_position;
+            m_inode = other.m_inode;
+            m_size = other.m_size;
+            m_fingerprint = other.m_fingerprint;
+            m_fingerprint_length = other.m_fingerprint_length;
+            m_multiline = std::move(other.m_multiline);
+            m_repeats = std::move(other.m_repeats);
+            m_filter = std::move(other.m_filter);
+            m_down = other.m_down;
+            m_last_updated = other.m_last_updated;
+            m_timeout_triggered = other.m_timeout_triggered;
+            other.m_fd = -1;
+        }
+        return *this;
+    }
 
     void set_position(pos_type pos) noexcept { m_position = pos; }
     [[nodiscard]] pos_type get_position() const noexcept { return m_position; }
@@ -52,6 +93,24 @@ class logfile
     void set_size(size_type size) noexcept { m_size = size; }
     [[nodiscard]] size_type get_size() const noexcept { return m_size; }
 
+    // Hash of the first bytes of the file, to tell a truncated or replaced file from the one already read.
+    void set_fingerprint(std::uint64_t fingerprint, std::size_t length) noexcept
+    {
+        m_fingerprint = fingerprint;
+        m_fingerprint_length = length;
+    }
+    [[nodiscard]] std::uint64_t get_fingerprint() const noexcept { return m_fingerprint; }
+    [[nodiscard]] std::size_t get_fingerprint_length() const noexcept { return m_fingerprint_length; }
+
+    // Assembler of multi-line records, if configured.
+    [[nodiscard]] std::optional<multiline_assembler> & multiline() noexcept { return m_multiline; }
+
+    // Folder of repeated lines, if configured.
+    [[nodiscard]] std::optional<repeat_folder> & repeats() noexcept { return m_repeats; }
+
+    // Filter of noise lines, if configured.
+    [[nodiscard]] std::optional<line_filter> & filter() noexcept { return m_filter; }
+
     [[nodiscard]] const std::string & path() const { return m_config.path; }
     [[nodiscard]] const logfile_config & config() const { return m_config; }
     [[nodiscard]] std::time_t last_updated() const { return m_last_updated; }
@@ -70,6 +129,11 @@ class logfile
     pos_type m_position{ 0 };
     inode_type m_inode{ static_cast<inode_type>(-1) };
     size_type m_size{ -1 };
+    std::uint64_t m_fingerprint{ 0 };
+    std::size_t m_fingerprint_length{ 0 };
+    std::optional<multiline_assembler> m_multiline;
+    std::optional<repeat_folder> m_repeats;
+    std::optional<line_filter> m_filter;
 
     bool m_down{ false };
     std::time_t m_last_updated{ 0 };
@@ -0,0 +1,57 @@
+#include "multiline.hpp"
+
+namespace ctguard::logscan {
+
+multiline_assembler::multiline_assembler(const multiline_config & cfg)
+  : m_indent{ cfg.mode == multiline_config::mode_t::INDENT },
+    m_start{ m_indent ? std::regex{} : std::regex{ cfg.start, std::regex::ECMAScript | std::regex::nosubs | std::regex::optimize } },
+    m_timeout{ cfg.timeout }
+{}
+
+std::optional<std::string> multiline_assembler::push(std::string_view line)
+{
+    bool continuation{ false };
+    if (m_lines > 0 && m_lines < MAX_LINES && !line.empty()) {
+        if (m_indent) {
+            continuation = line.front() == ' ' || line.front() == '\t';
+        } else {
+            continuation = !std::regex_search(line.data(), line.data() + line.size(), m_start);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+    }
+
+    m_last = clock::now();
+    if (continuation) {
+        m_record += '\n';
+        m_record += line;
+        m_lines++;
+        return std::nullopt;
+    }
+
+    std::optional<std::string> done{ flush() };
+    m_record = line;
+    m_lines = 1;
+    return done;
+}
+
+std::optional<std::string> multiline_assembler::flush()
+{
+    if (m_lines == 0) {
+        return std::nullopt;
+    }
+
+    m_lines = 0;
+    std::optional<std::string> done{ std::move(m_record) };
+    m_record.clear();
+    return done;
+}
+
+std::optional<multiline_assembler::clock::time_point> multiline_assembler::deadline() const
+{
+    if (m_lines == 0) {
+        return std::nullopt;
+    }
+
+    return m_last + m_timeout;
+}
+
+} /* namespace ctguard::logscan */
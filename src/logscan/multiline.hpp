@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+
+#include "config.hpp"
+
+namespace ctguard::logscan {
+
+// Joins the lines of a multi-line record, like a stack trace, into one message separated by newlines.
+class multiline_assembler
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+    // Records are passed on at this size at the latest.
+    static constexpr std::size_t MAX_LINES{ 1000 };
+
+    explicit multiline_assembler(const multiline_config & cfg);
+
+    // Add a line; returns the previous record if the line starts a new one.
+    [[nodiscard]] std::optional<std::string> push(std::string_view line);
+
+    // Take the pending record, e.g. on timeout or when the file is switched.
+    [[nodiscard]] std::optional<std::string> flush();
+
+    // When the pending record is complete by timeout, if there is one.
+    [[nodiscard]] std::optional<clock::time_point> deadline() const;
+
+  private:
+    bool m_indent;
+    std::regex m_start;
+    std::chrono::seconds m_timeout;
+    std::string m_record;
+    std::size_t m_lines{ 0 };
+    clock::time_point m_last;
+};
+
+} /* namespace ctguard::logscan */
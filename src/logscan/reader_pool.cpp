@@ -0,0 +1,99 @@
+#include "reader_pool.hpp"
+
+namespace ctguard::logscan {
+
+reader_pool::reader_pool(unsigned threads)
+{
+    m_threads.reserve(threads > 0 ? threads - 1 : 0);
+    for (unsigned i = 1; i < threads; ++i) {
+        m_threads.emplace_back(&reader_pool::work, this, i);
+    }
+}
+
+reader_pool::~reader_pool()
+{
+    {
+        std::lock_guard lg{ m_mutex };
+        m_stop = true;
+    }
+    m_start.notify_all();
+
+    for (auto & t : m_threads) {
+        t.join();
+    }
+}
+
+void reader_pool::run(std::size_t jobs, const job_fn & fn)
+{
+    if (jobs == 0) {
+        return;
+    }
+
+    if (jobs == 1 || m_threads.empty()) {
+        for (std::size_t i = 0; i < jobs; ++i) {
+            fn(i, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lg{ m_mutex };
+        m_fn = &fn;
+        m_jobs = jobs;
+        m_next = 0;
+        m_running = static_cast<unsigned>(m_threads.size());
+        m_error = nullptr;
+        m_generation++;
+    }
+    m_start.notify_all();
+
+    process(0);
+
+    std::unique_lock ul{ m_mutex };
+    m_done.wait(ul, [this]() { return m_running == 0; });
+    m_fn = nullptr;
+
+    if (m_error) {
+        std::rethrow_exception(m_error);
+    }
+}
+
+void reader_pool::process(unsigned worker)
+{
+    for (std::size_t job = m_next++; job < m_jobs; job = m_next++) {
+        try {
+            (*m_fn)(job, worker);
+        } catch (...) {
+            std::lock_guard lg{ m_mutex };
+            if (!m_error) {
+                m_error = std::current_exception();
+            }
+        }
+    }
+}
+
+void reader_pool::work(unsigned worker)
+{
+    std::uint64_t generation{ 0 };
+
+    for (;;) {
+        {
+            std::unique_lock ul{ m_mutex };
+            m_start.wait(ul, [this, generation]() { return m_stop || m_generation != generation; });
+            if (m_stop) {
+                return;
+            }
+            generation = m_generation;
+        }
+
+        process(worker);
+
+        {
+            std::lock_guard lg{ m_mutex };
+            m_running--;
+        }
+        m_done.notify_one();
+    }
+}
+
+} /* namespace ctguard::logscan */
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ctguard::logscan {
+
+// Fixed set of threads running the jobs of one batch in parallel; the calling thread takes part as worker 0.
+// Every job runs exactly once on a single worker, so work done per job stays in order.
+class reader_pool
+{
+  public:
+    using job_fn = std::function<void(std::size_t job, unsigned worker)>;
+
+    explicit reader_pool(unsigned threads);
+    ~reader_pool();
+
+    reader_pool(const reader_pool &) = delete;
+    reader_pool & operator=(const reader_pool &) = delete;
+    reader_pool(reader_pool &&) = delete;
+    reader_pool & operator=(reader_pool &&) = delete;
+
+    // Number of workers, including the calling thread.
+    [[nodiscard]] unsigned size() const noexcept { return static_cast<unsigned>(m_threads.size()) + 1; }
+
+    // Run fn for the jobs [0, jobs) and wait for all of them; rethrows the first exception of a job.
+    void run(std::size_t jobs, const job_fn & fn);
+
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    const job_fn * m_fn{ nullptr };
+    std::size_t m_jobs{ 0 };
+    std::atomic<std::size_t> m_next{ 0 };
+    unsigned m_running{ 0 };
+    std::uint64_t m_generation{ 0 };
+    bool m_stop{ false };
+    std::exception_ptr m_error;
+    std::vector<std::thread> m_threads;
+
+    void work(unsigned worker);
+    void process(unsigned worker);
+};
+
+} /* namespace ctguard::logscan */
@@ -0,0 +1,74 @@
+#include "repeat_folder.hpp"
+
+#include <algorithm>
+
+#include "../libs/hash.hpp"
+
+namespace ctguard::logscan {
+
+bool repeat_folder::pass(std::string_view message, clock::time_point now)
+{
+    const std::uint64_t hash = libs::fnv1a(message);
+
+    for (auto & e : m_entries) {
+        if (e.hash != hash || e.message != message) {
+            continue;
+        }
+
+        if (e.end > now) {
+            e.repeats++;
+            return false;
+        }
+
+        // window over, but not yet expired: start a new one
+        if (e.repeats > 0) {
+            m_done.emplace_back(e.message, e.repeats);
+        }
+        e.repeats = 0;
+        e.end = now + m_window;
+        return true;
+    }
+
+    if (m_entries.size() >= WINDOW_SIZE) {
+        const auto oldest = std::min_element(m_entries.begin(), m_entries.end(), [](const entry & a, const entry & b) { return a.end < b.end; });
+        if (oldest->repeats > 0) {
+            m_done.emplace_back(std::move(oldest->message), oldest->repeats);
+        }
+        m_entries.erase(oldest);
+    }
+
+    m_entries.push_back(entry{ hash, std::string{ message }, 0, now + m_window });
+    return true;
+}
+
+std::vector<repeat_folder::summary> repeat_folder::expire(clock::time_point now)
+{
+    std::vector<summary> done;
+    done.swap(m_done);
+
+    for (auto & e : m_entries) {
+        if (e.end <= now && e.repeats > 0) {
+            done.emplace_back(std::move(e.message), e.repeats);
+        }
+    }
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [now](const entry & e) { return e.end <= now; }), m_entries.end());
+
+    return done;
+}
+
+std::optional<repeat_folder::clock::time_point> repeat_folder::deadline() const
+{
+    if (!m_done.empty()) {
+        return clock::time_point::min();
+    }
+
+    std::optional<clock::time_point> next;
+    for (const auto & e : m_entries) {
+        if (e.repeats > 0 && (!next.has_value() || e.end < *next)) {
+            next = e.end;
+        }
+    }
+    return next;
+}
+
+} /* namespace ctguard::logscan */
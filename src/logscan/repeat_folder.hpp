@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ctguard::logscan {
+
+// Folds identical messages of one logfile within a time window: the first one is passed on at once,
+// the repeats are only counted and passed on as a single summary when the window is over.
+class repeat_folder
+{
+  public:
+    using clock = std::chrono::steady_clock;
+    using summary = std::pair<std::string, unsigned>;  // message and number of repeats
+
+    // Number of distinct messages tracked at once; the one with the earliest end of window is dropped first.
+    static constexpr std::size_t WINDOW_SIZE{ 64 };
+
+    explicit repeat_folder(std::chrono::seconds window) : m_window{ window } {}
+
+    // Whether message is to be passed on, false if it repeats a recent one.
+    [[nodiscard]] bool pass(std::string_view message, clock::time_point now);
+
+    // Take the summaries of repeated messages whose window is over at now.
+    [[nodiscard]] std::vector<summary> expire(clock::time_point now);
+
+    // When the next summary is due, if any.
+    [[nodiscard]] std::optional<clock::time_point> deadline() const;
+
+  private:
+    struct entry
+    {
+        std::uint64_t hash;
+        std::string message;
+        unsigned repeats;
+        clock::time_point end;
+    };
+
+    std::chrono::seconds m_window;
+    std::vector<entry> m_entries;
+    std::vector<summary> m_done;  // of entries dropped early
+};
+
+} /* namespace ctguard::logscan */
@@ -0,0 +1,347 @@
+#include "state_store.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+
+#include "../libs/hash.hpp"
+#include "../libs/logger.hpp"
+
+namespace ctguard::logscan {
+
+static constexpr std::uint32_t STATE_VERSION{ 1 };
+static constexpr std::array<char, 16> STATE_MAGIC{ "ctguard-logscan" };
+
+struct state_header
+{
+    std::array<char, 16> magic;
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::array<char, 40> reserved;
+};
+static_assert(sizeof(state_header) == 64, "header should fill the first record slot");
+
+[[nodiscard]] static std::uint64_t key_of(const std::string & logfile) noexcept
+{
+    const std::uint64_t key = libs::fnv1a(logfile);
+    return key != 0 ? key : 1;  // 0 marks free slots
+}
+
+[[nodiscard]] static bool pwrite_all(int fd, const void * data, std::size_t size, off_t offset)
+{
+    const auto * bytes = static_cast<const char *>(data);
+    while (size > 0) {
+        const ssize_t ret = ::pwrite(fd, bytes, size, offset);
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += ret;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        size -= static_cast<std::size_t>(ret);
+        offset += ret;
+    }
+    return true;
+}
+
+state_store::state_store(std::string path) : m_path{ std::move(path) }
+{
+    m_fd = ::open(m_path.c_str(), O_RDWR | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    if (m_fd == -1) {
+        if (errno == ENOENT) {
+            FILE_LOG(libs::log_level::INFO) << "No statefile; clean start";
+        } else {
+            FILE_LOG(libs::log_level::ERROR) << "Can not open state file '" << m_path << "' : " << ::strerror(errno);
+            FILE_LOG(libs::log_level::WARNING) << "Ignoring state file; clean start";
+        }
+        m_rewrite = true;
+        return;
+    }
+
+    std::vector<char> content;
+    std::array<char, 64 * 1024> buffer;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    for (;;) {
+        const ssize_t ret = ::read(m_fd, buffer.data(), buffer.size());
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            FILE_LOG(libs::log_level::ERROR) << "Can not read state file '" << m_path << "' : " << ::strerror(errno);
+            FILE_LOG(libs::log_level::WARNING) << "Ignoring state file; clean start";
+            m_rewrite = true;
+            return;
+        }
+        if (ret == 0) {
+            break;
+        }
+        content.insert(content.end(), buffer.data(), buffer.data() + ret);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    if (content.size() >= sizeof(state_header) && std::memcmp(content.data(), STATE_MAGIC.data(), STATE_MAGIC.size()) == 0) {
+        load_binary(content);
+    } else if (!content.empty() && content[0] == '"') {
+        FILE_LOG(libs::log_level::INFO) << "Converting state file '" << m_path << "' from text format";
+        load_text(content);
+        m_rewrite = true;
+    } else {
+        if (!content.empty()) {
+            FILE_LOG(libs::log_level::ERROR) << "State file '" << m_path << "' has an unknown format";
+            FILE_LOG(libs::log_level::WARNING) << "Ignoring state file; clean start";
+        }
+        m_rewrite = true;
+    }
+
+    FILE_LOG(libs::log_level::DEBUG) << "Loaded state of " << m_slots.size() << " logfile(s)";
+}
+
+state_store::~state_store()
+{
+    if (m_fd != -1) {
+        ::close(m_fd);
+    }
+}
+
+std::uint64_t state_store::checksum(const record & r) noexcept { return libs::fnv1a(&r, offsetof(record, checksum)); }
+
+void state_store::load_binary(const std::vector<char> & content)
+{
+    state_header header;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    std::memcpy(&header, content.data(), sizeof header);
+    if (header.version != STATE_VERSION || header.record_size != sizeof(record)) {
+        FILE_LOG(libs::log_level::ERROR) << "State file '" << m_path << "' has unsupported version " << header.version;
+        FILE_LOG(libs::log_level::WARNING) << "Ignoring state file; clean start";
+        m_rewrite = true;
+        return;
+    }
+
+    const std::size_t size = content.size() - sizeof header;
+    if (size % sizeof(record) != 0) {
+        FILE_LOG(libs::log_level::WARNING) << "State file '" << m_path << "' has a truncated record";
+        m_rewrite = true;
+    }
+
+    m_records.resize(size / sizeof(record));
+    std::memcpy(m_records.data(), content.data() + sizeof header, m_records.size() * sizeof(record));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+    for (std::size_t slot = 0; slot < m_records.size(); ++slot) {
+        record & r = m_records[slot];
+        if (r.key == 0) {
+            m_free.push_back(slot);
+            continue;
+        }
+
+        if (r.checksum != checksum(r)) {
+            FILE_LOG(libs::log_level::WARNING) << "State file '" << m_path << "' has a corrupted record, dropping it";
+        } else if (!m_slots.try_emplace(r.key, slot).second) {
+            FILE_LOG(libs::log_level::WARNING) << "State file '" << m_path << "' has a duplicate record, dropping it";
+        } else {
+            continue;
+        }
+
+        r = record{};
+        m_free.push_back(slot);
+        m_dirty.insert(slot);
+    }
+}
+
+void state_store::load_text(const std::vector<char> & content)
+{
+    std::istringstream state_file{ std::string{ content.data(), content.size() } };
+    std::string line;
+    while (std::getline(state_file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+
+        FILE_LOG(libs::log_level::DEBUG) << "State file line: '" << line << "'";
+        const auto pathpos = line.find('"', 1);
+        if (pathpos == std::string::npos) {
+            FILE_LOG(libs::log_level::ERROR) << "State file '" << m_path << "' has invalid line: '" << line << "'";
+            continue;
+        }
+
+        const std::string file{ line.substr(1, pathpos - 1) };
+        const std::string rest{ line.substr(pathpos + 2) };
+        std::istringstream is{ rest };
+        entry e;
+
+        is >> e.inode;
+        if (is.fail() || is.get() != ',') {
+            FILE_LOG(libs::log_level::ERROR) << "State file '" << m_path << "' has invalid node section: '" << rest << "'";
+            continue;
+        }
+
+        is >> e.position;
+        if (is.fail()) {
+            FILE_LOG(libs::log_level::ERROR) << "State file '" << m_path << "' has invalid position section: '" << rest << "'";
+            continue;
+        }
+
+        FILE_LOG(libs::log_level::DEBUG) << "Extracted state: '" << file << "', '" << e.inode << "', '" << e.position << "'";
+
+        update(file, e);
+    }
+}
+
+std::optional<state_store::entry> state_store::find(const std::string & logfile) const
+{
+    const auto it = m_slots.find(key_of(logfile));
+    if (it == m_slots.end()) {
+        return std::nullopt;
+    }
+
+    const record & r = m_records[it->second];
+    return entry{ r.inode, r.position, r.fingerprint, r.fingerprint_length };
+}
+
+void state_store::update(const std::string & logfile, const entry & e)
+{
+    const std::uint64_t key = key_of(logfile);
+
+    std::size_t slot;  // NOLINT(cppcoreguidelines-init-variables)
+    if (const auto it = m_slots.find(key); it != m_slots.end()) {
+        slot = it->second;
+        const record & r = m_records[slot];
+        if (r.inode == e.inode && r.position == e.position && r.fingerprint == e.fingerprint && r.fingerprint_length == e.fingerprint_length) {
+            return;
+        }
+    } else {
+        if (m_free.empty()) {
+            slot = m_records.size();
+            m_records.emplace_back();
+        } else {
+            slot = m_free.back();
+            m_free.pop_back();
+        }
+        m_slots.emplace(key, slot);
+    }
+
+    m_records[slot] = record{ key, e.inode, e.position, e.fingerprint, e.fingerprint_length, 0, 0, 0, 0 };
+    m_dirty.insert(slot);
+}
+
+void state_store::remove(const std::string & logfile)
+{
+    const auto it = m_slots.find(key_of(logfile));
+    if (it == m_slots.end()) {
+        return;
+    }
+
+    m_records[it->second] = record{};
+    m_free.push_back(it->second);
+    m_dirty.insert(it->second);
+    m_slots.erase(it);
+}
+
+void state_store::retain(const std::set<std::string> & logfiles)
+{
+    std::set<std::uint64_t> keys;
+    for (const auto & logfile : logfiles) {
+        keys.insert(key_of(logfile));
+    }
+
+    for (auto it = m_slots.begin(); it != m_slots.end();) {
+        if (keys.count(it->first) > 0) {
+            ++it;
+            continue;
+        }
+
+        m_records[it->second] = record{};
+        m_free.push_back(it->second);
+        it = m_slots.erase(it);
+        m_rewrite = true;
+    }
+}
+
+void state_store::flush()
+{
+    if (m_rewrite || m_fd == -1) {
+        rewrite();
+        return;
+    }
+
+    // write runs of adjacent changed records at once
+    for (auto it = m_dirty.begin(); it != m_dirty.end();) {
+        const std::size_t first = *it;
+        std::size_t last = first;
+        for (++it; it != m_dirty.end() && *it == last + 1; ++it) {
+            ++last;
+        }
+
+        for (std::size_t slot = first; slot <= last; ++slot) {
+            if (m_records[slot].key != 0) {
+                m_records[slot].checksum = checksum(m_records[slot]);
+            }
+        }
+
+        if (!pwrite_all(m_fd, &m_records[first], (last - first + 1) * sizeof(record), static_cast<off_t>(sizeof(state_header) + first * sizeof(record)))) {
+            FILE_LOG(libs::log_level::ERROR) << "Can not write state file '" << m_path << "': " << ::strerror(errno);
+            FILE_LOG(libs::log_level::WARNING) << "State not saved to disk";
+            m_rewrite = true;
+            return;
+        }
+    }
+
+    m_dirty.clear();
+}
+
+void state_store::rewrite()
+{
+    // compact, dropping free slots
+    std::vector<record> records;
+    records.reserve(m_slots.size());
+    m_slots.clear();
+    for (record & r : m_records) {
+        if (r.key == 0) {
+            continue;
+        }
+        r.checksum = checksum(r);
+        m_slots.emplace(r.key, records.size());
+        records.push_back(r);
+    }
+    m_records.swap(records);
+    m_free.clear();
+    m_dirty.clear();
+
+    const std::string state_file_tmp = m_path + ".tmp";
+    const int fd = ::open(state_file_tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    if (fd == -1) {
+        FILE_LOG(libs::log_level::ERROR) << "Can not open state file '" << state_file_tmp << "': " << ::strerror(errno);
+        FILE_LOG(libs::log_level::WARNING) << "State not saved to disk";
+        return;
+    }
+
+    state_header header{};
+    header.magic = STATE_MAGIC;
+    header.version = STATE_VERSION;
+    header.record_size = sizeof(record);
+    if (!pwrite_all(fd, &header, sizeof header, 0) ||
+        !pwrite_all(fd, m_records.data(), m_records.size() * sizeof(record), static_cast<off_t>(sizeof header))) {
+        FILE_LOG(libs::log_level::ERROR) << "Can not write state file '" << state_file_tmp << "': " << ::strerror(errno);
+        FILE_LOG(libs::log_level::WARNING) << "State not saved to disk";
+        ::close(fd);
+        ::unlink(state_file_tmp.c_str());
+        return;
+    }
+
+    if (::rename(state_file_tmp.c_str(), m_path.c_str()) == -1) {
+        FILE_LOG(libs::log_level::ERROR) << "Can not rename '" << state_file_tmp << "' to '" << m_path << "': " << ::strerror(errno);
+        FILE_LOG(libs::log_level::WARNING) << "State not saved to disk";
+        ::close(fd);
+        return;
+    }
+
+    if (m_fd != -1) {
+        ::close(m_fd);
+    }
+    m_fd = fd;
+    m_rewrite = false;
+}
+
+} /* namespace ctguard::logscan */
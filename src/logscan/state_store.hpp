@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ctguard::logscan {
+
+// Saved reading state of the logfiles, in a binary file of fixed-size records keyed by the hash of the logfile path.
+// Only changed records are written, in place; every record carries a checksum, so a torn write loses only that record.
+class state_store
+{
+  public:
+    struct entry
+    {
+        std::uint64_t inode{ 0 };
+        std::uint64_t position{ 0 };
+        std::uint64_t fingerprint{ 0 };
+        std::uint32_t fingerprint_length{ 0 };
+    };
+
+    // Load the state file at path; a missing or invalid file means a clean start. The former text format is read too.
+    explicit state_store(std::string path);
+    ~state_store();
+
+    state_store(const state_store &) = delete;
+    state_store & operator=(const state_store &) = delete;
+    state_store(state_store &&) = delete;
+    state_store & operator=(state_store &&) = delete;
+
+    [[nodiscard]] std::optional<entry> find(const std::string & logfile) const;
+
+    // Set the state of logfile, written by the next flush if changed.
+    void update(const std::string & logfile, const entry & e);
+
+    // Forget logfile, e.g. after it got removed.
+    void remove(const std::string & logfile);
+
+    // Forget all logfiles not in logfiles, e.g. no longer configured ones.
+    void retain(const std::set<std::string> & logfiles);
+
+    // Write the changed records; the whole file is replaced via rename after loading the text format or dropping records.
+    // Errors are logged, the state is written again by the next flush.
+    void flush();
+
+  private:
+    // host byte order, the file is not meant to be moved between machines
+    struct record
+    {
+        std::uint64_t key;  // 0 for a free slot
+        std::uint64_t inode;
+        std::uint64_t position;
+        std::uint64_t fingerprint;
+        std::uint32_t fingerprint_length;
+        std::uint32_t reserved1;
+        std::uint64_t reserved2;
+        std::uint64_t reserved3;
+        std::uint64_t checksum;
+    };
+    static_assert(sizeof(record) == 64, "records should not cross disk sectors");
+
+    std::string m_path;
+    int m_fd{ -1 };
+    std::vector<record> m_records;                           // by slot
+    std::unordered_map<std::uint64_t, std::size_t> m_slots;  // key -> slot
+    std::vector<std::size_t> m_free;
+    std::set<std::size_t> m_dirty;
+    bool m_rewrite{ false };
+
+    [[nodiscard]] static std::uint64_t checksum(const record & r) noexcept;
+    void load_binary(const std::vector<char> & content);
+    void load_text(const std::vector<char> & content);
+    void rewrite();
+};
+
+} /* namespace ctguard::logscan */
@@ -0,0 +1,69 @@
+#include "systemd_receiver.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "../libs/logger.hpp"
+
+namespace ctguard::logscan {
+
+std::size_t systemd_receiver::receive(int socket, std::size_t max, const std::function<void(std::string_view)> & cb)
+{
+    std::size_t total{ 0 };
+
+    while (total < max) {
+        const std::size_t want = std::min(BATCH_SIZE, max - total);
+        for (std::size_t i = 0; i < want; ++i) {
+            m_iovecs[i].iov_base = m_buffer.data() + i * MESSAGE_SIZE;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            m_iovecs[i].iov_len = MESSAGE_SIZE;
+            m_headers[i].msg_hdr = {};
+            m_headers[i].msg_hdr.msg_iov = &m_iovecs[i];
+            m_headers[i].msg_hdr.msg_iovlen = 1;
+            m_headers[i].msg_hdr.msg_control = m_controls[i].data.data();
+            m_headers[i].msg_hdr.msg_controllen = m_controls[i].data.size();
+        }
+
+        const int n = ::recvmmsg(socket, m_headers.data(), static_cast<unsigned>(want), MSG_DONTWAIT, nullptr);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                FILE_LOG(libs::log_level::WARNING) << "systemd input Recv error: " << ::strerror(errno);
+            }
+            break;
+        }
+
+        for (std::size_t i = 0; i < static_cast<std::size_t>(n); ++i) {
+            struct ::msghdr & hdr = m_headers[i].msg_hdr;
+
+            for (struct ::cmsghdr * cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+                    std::uint32_t drops;  // NOLINT(cppcoreguidelines-init-variables)
+                    std::memcpy(&drops, CMSG_DATA(cmsg), sizeof drops);
+                    // the kernel counter wraps around
+                    m_dropped += drops - m_kernel_drops;
+                    m_kernel_drops = drops;
+                }
+            }
+
+            if (hdr.msg_flags & MSG_TRUNC) {
+                FILE_LOG(libs::log_level::WARNING) << "systemd input message truncated to " << MESSAGE_SIZE << " bytes";
+                m_truncated++;
+            }
+
+            cb(std::string_view{ static_cast<const char *>(m_iovecs[i].iov_base), m_headers[i].msg_len });
+        }
+
+        total += static_cast<std::size_t>(n);
+        m_received += static_cast<std::size_t>(n);
+        if (static_cast<std::size_t>(n) < want) {
+            break;
+        }
+    }
+
+    return total;
+}
+
+} /* namespace ctguard::logscan */
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <sys/socket.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace ctguard::logscan {
+
+// Receives the datagrams forwarded by systemd-journald in batches, into buffers reused across calls.
+class systemd_receiver
+{
+  public:
+    static constexpr std::size_t BATCH_SIZE{ 16 };
+    static constexpr std::size_t MESSAGE_SIZE{ 64 * 1024 };
+
+    systemd_receiver() : m_buffer(BATCH_SIZE * MESSAGE_SIZE) {}
+
+    systemd_receiver(const systemd_receiver &) = delete;
+    systemd_receiver & operator=(const systemd_receiver &) = delete;
+    systemd_receiver(systemd_receiver &&) = delete;
+    systemd_receiver & operator=(systemd_receiver &&) = delete;
+
+    // Receive up to max datagrams pending on the non-blocking socket and pass them to cb; returns the number received.
+    // Datagrams longer than MESSAGE_SIZE are passed on truncated.
+    std::size_t receive(int socket, std::size_t max, const std::function<void(std::string_view)> & cb);
+
+    [[nodiscard]] std::uint64_t received() const noexcept { return m_received; }
+    [[nodiscard]] std::uint64_t truncated() const noexcept { return m_truncated; }
+    // Datagrams dropped by the kernel, as reported via SO_RXQ_OVFL.
+    [[nodiscard]] std::uint64_t dropped() const noexcept { return m_dropped; }
+
+  private:
+    struct alignas(struct ::cmsghdr) control_buffer
+    {
+        std::array<char, CMSG_SPACE(sizeof(std::uint32_t))> data;
+    };
+
+    std::vector<char> m_buffer;
+    std::array<struct ::mmsghdr, BATCH_SIZE> m_headers{};
+    std::array<struct ::iovec, BATCH_SIZE> m_iovecs{};
+    std::array<control_buffer, BATCH_SIZE> m_controls{};
+    std::uint64_t m_received{ 0 };
+    std::uint64_t m_truncated{ 0 };
+    std::uint64_t m_dropped{ 0 };
+    std::uint32_t m_kernel_drops{ 0 };
+};
+
+} /* namespace ctguard::logscan */
@@ -0,0 +1,242 @@
+#include "approx_window.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "../libs/hash.hpp"
+
+namespace ctguard::research {
+
+// rough per entry overhead of the node based containers
+static constexpr std::size_t NODE_OVERHEAD{ 64 };
+static constexpr std::size_t MIN_WIDTH{ 64 };
+
+static std::size_t key_bytes(const std::string & key) noexcept
+{
+    return key.size() + NODE_OVERHEAD + approx_window::BUCKETS * sizeof(std::pair<std::time_t, std::uint32_t>);
+}
+
+static std::size_t log_bytes(const std::string & logstr) noexcept { return logstr.size() + NODE_OVERHEAD; }
+
+void approx_window::configure(unsigned window_time, std::size_t memory_cap)
+{
+    if (window_time == m_window_time && memory_cap == m_memory_cap) {
+        return;
+    }
+
+    *this = approx_window{};
+    m_window_time = window_time;
+    m_memory_cap = memory_cap;
+    // BUCKETS - 1 buckets cover the window, the remaining one is the currently filling bucket
+    m_bucket_time = std::max<std::time_t>(1, static_cast<std::time_t>((window_time + BUCKETS - 2) / (BUCKETS - 1)));
+    // half of the memory for the sketches, the rest for exactly tracked keys
+    m_width = std::max(MIN_WIDTH, memory_cap / 2 / (BUCKETS * DEPTH * sizeof(std::uint32_t)));
+}
+
+bool approx_window::in_window(std::time_t bucket_start, std::time_t now) const noexcept
+{
+    return bucket_start != 0 && bucket_start + m_bucket_time + m_window_time > now;
+}
+
+std::array<std::size_t, approx_window::DEPTH> approx_window::cells(const std::string & key) const noexcept
+{
+    const std::uint64_t h1 = libs::fnv1a(key);
+    const std::uint64_t h2 = libs::mix64(h1) | 1U;
+    std::array<std::size_t, DEPTH> result;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    for (std::size_t i = 0; i < DEPTH; ++i) {
+        result[i] = (h1 + i * h2) % m_width;
+    }
+    return result;
+}
+
+std::uint32_t approx_window::estimate(std::size_t bucket, const std::array<std::size_t, DEPTH> & key_cells) const noexcept
+{
+    std::uint32_t result{ std::numeric_limits<std::uint32_t>::max() };
+    for (std::size_t i = 0; i < DEPTH; ++i) {
+        result = std::min(result, m_counters[(bucket * DEPTH + i) * m_width + key_cells[i]]);
+    }
+    return result;
+}
+
+std::size_t approx_window::exact_budget() const noexcept
+{
+    const std::size_t sketch_bytes = BUCKETS * DEPTH * m_width * sizeof(std::uint32_t);
+    return m_memory_cap > sketch_bytes ? m_memory_cap - sketch_bytes : 0;
+}
+
+bool approx_window::store_log(exact_key & ek, const std::string & logstr, std::time_t now)
+{
+    if (m_exact_bytes + log_bytes(logstr) > exact_budget()) {
+        m_cap_hits++;
+        const bool newly_capped = !m_capped;
+        m_capped = true;
+        return newly_capped;
+    }
+
+    ek.logs.emplace(now, logstr);
+    m_exact_bytes += log_bytes(logstr);
+    return false;
+}
+
+void approx_window::expire(std::time_t now)
+{
+    for (auto it = m_exact.begin(); it != m_exact.end();) {
+        auto & ek = it->second;
+
+        while (!ek.logs.empty() && ek.logs.begin()->first + m_window_time < now) {
+            m_exact_bytes -= log_bytes(ek.logs.begin()->second);
+            ek.logs.erase(ek.logs.begin());
+        }
+        ek.counts.erase(std::remove_if(ek.counts.begin(), ek.counts.end(), [this, now](const auto & elem) { return !in_window(elem.first, now); }),
+                        ek.counts.end());
+
+        if (ek.counts.empty() && ek.logs.empty()) {
+            m_exact_bytes -= key_bytes(it->first);
+            it = m_exact.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // re-arm the cap warning once a quarter of the budget is free again
+    if (m_capped && m_exact_bytes < exact_budget() / 4 * 3) {
+        m_capped = false;
+    }
+}
+
+bool approx_window::add(const std::string & key, const std::string & logstr, std::time_t now, unsigned threshold, std::uint64_t hits)
+{
+    constexpr std::uint32_t max_count{ std::numeric_limits<std::uint32_t>::max() };
+    const auto add_saturated = [hits](std::uint32_t & counter) { counter = static_cast<std::uint32_t>(std::min<std::uint64_t>(max_count, counter + hits)); };
+
+    if (m_counters.empty()) {
+        m_counters.resize(BUCKETS * DEPTH * m_width, 0);
+        m_bucket_start.resize(BUCKETS, 0);
+    }
+
+    const std::time_t slot = now / m_bucket_time;
+    const auto bucket = static_cast<std::size_t>(slot) % BUCKETS;
+    const std::time_t bucket_start = slot * m_bucket_time;
+    if (m_bucket_start[bucket] != bucket_start) {
+        std::fill_n(m_counters.begin() + static_cast<std::ptrdiff_t>(bucket * DEPTH * m_width), DEPTH * m_width, 0);
+        m_bucket_start[bucket] = bucket_start;
+        expire(now);
+    }
+
+    auto iter = m_exact.find(key);
+    if (iter != m_exact.end()) {
+        auto & counts = iter->second.counts;
+        if (counts.empty() || counts.back().first != bucket_start) {
+            counts.emplace_back(bucket_start, 0);
+        }
+        add_saturated(counts.back().second);
+        return store_log(iter->second, logstr, now);
+    }
+
+    const auto key_cells = cells(key);
+    for (std::size_t i = 0; i < DEPTH; ++i) {
+        add_saturated(m_counters[(bucket * DEPTH + i) * m_width + key_cells[i]]);
+    }
+
+    exact_key ek;
+    std::uint64_t estimated{ 0 };
+    for (std::size_t b = 0; b < BUCKETS; ++b) {
+        if (!in_window(m_bucket_start[b], now)) {
+            continue;
+        }
+        const std::uint32_t est = estimate(b, key_cells);
+        if (est != 0) {
+            ek.counts.emplace_back(m_bucket_start[b], est);
+            estimated += est;
+        }
+    }
+
+    if (estimated < threshold) {
+        return false;
+    }
+
+    // escalate
+    if (m_exact_bytes + key_bytes(key) > exact_budget()) {
+        m_cap_hits++;
+        const bool newly_capped = !m_capped;
+        m_capped = true;
+        return newly_capped;
+    }
+
+    std::sort(ek.counts.begin(), ek.counts.end());
+    m_exact_bytes += key_bytes(key);
+    auto & inserted = m_exact.emplace(key, std::move(ek)).first->second;
+    return store_log(inserted, logstr, now);
+}
+
+std::uint64_t approx_window::count(const std::string & key, std::time_t now) const
+{
+    std::uint64_t result{ 0 };
+
+    const auto iter = m_exact.find(key);
+    if (iter != m_exact.end()) {
+        for (const auto & elem : iter->second.counts) {
+            if (in_window(elem.first, now)) {
+                result += elem.second;
+            }
+        }
+        return result;
+    }
+
+    if (m_counters.empty()) {
+        return 0;
+    }
+
+    const auto key_cells = cells(key);
+    for (std::size_t b = 0; b < BUCKETS; ++b) {
+        if (in_window(m_bucket_start[b], now)) {
+            result += estimate(b, key_cells);
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> approx_window::logs(const std::string & key, std::time_t now) const
+{
+    std::vector<std::string> result;
+
+    const auto iter = m_exact.find(key);
+    if (iter != m_exact.end()) {
+        for (const auto & elem : iter->second.logs) {
+            if (elem.first + m_window_time >= now) {
+                result.push_back(elem.second);
+            }
+        }
+    }
+
+    return result;
+}
+
+void approx_window::reset(const std::string & key, std::time_t now)
+{
+    if (m_counters.empty()) {
+        return;
+    }
+
+    auto iter = m_exact.find(key);
+    if (iter != m_exact.end()) {
+        for (const auto & elem : iter->second.logs) {
+            m_exact_bytes -= log_bytes(elem.second);
+        }
+        iter->second.logs.clear();
+        iter->second.counts.clear();
+        // keep the now empty entry until the next expiry, so the sketch counts of the key are not used
+        iter->second.counts.emplace_back(now / m_bucket_time * m_bucket_time, 0);
+        return;
+    }
+
+    // the sketch can not forget a single key: track it exactly from zero if possible
+    if (m_exact_bytes + key_bytes(key) <= exact_budget()) {
+        exact_key ek;
+        ek.counts.emplace_back(now / m_bucket_time * m_bucket_time, 0);
+        m_exact_bytes += key_bytes(key);
+        m_exact.emplace(key, std::move(ek));
+    }
+}
+
+} /* namespace ctguard::research */
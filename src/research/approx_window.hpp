@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ctguard::research {
+
+// Memory bounded replacement of the saved events of an activation group with a same_field.
+// Events are counted per key in count-min sketches, one per time bucket of the activation window.
+// Keys whose estimated count crosses the escalation threshold are counted exactly from then on
+// and keep their log lines, as long as the memory cap of the rule allows it.
+// The estimated count of a key is never less than the real one.
+class approx_window
+{
+  public:
+    static constexpr std::size_t BUCKETS{ 8 };
+    static constexpr std::size_t DEPTH{ 4 };
+
+    // (Re-)initialize, dropping all data, if the window geometry changed.
+    void configure(unsigned window_time, std::size_t memory_cap);
+
+    // Count hits events of key with the log line logstr; returns true if the memory cap was hit and was not before.
+    [[nodiscard]] bool add(const std::string & key, const std::string & logstr, std::time_t now, unsigned threshold, std::uint64_t hits = 1);
+
+    // Estimated number of events of key within the window.
+    [[nodiscard]] std::uint64_t count(const std::string & key, std::time_t now) const;
+
+    // Log lines of key within the window, empty if the key is not tracked exactly.
+    [[nodiscard]] std::vector<std::string> logs(const std::string & key, std::time_t now) const;
+
+    // Forget all events of key.
+    void reset(const std::string & key, std::time_t now);
+
+    [[nodiscard]] bool empty() const noexcept { return m_counters.empty(); }
+    [[nodiscard]] std::size_t memory_usage() const noexcept { return m_counters.size() * sizeof(std::uint32_t) + m_exact_bytes; }
+    [[nodiscard]] std::uint64_t cap_hits() const noexcept { return m_cap_hits; }
+
+    template<class Archive>
+    void serialize(Archive & archive)
+    {
+        archive(m_window_time, m_memory_cap, m_bucket_time, m_width, m_bucket_start, m_counters, m_exact, m_exact_bytes, m_cap_hits, m_capped);
+    }
+
+  private:
+    struct exact_key
+    {
+        // counts per bucket start; estimated for the buckets before the escalation
+        std::vector<std::pair<std::time_t, std::uint32_t>> counts;
+        std::multimap<std::time_t, std::string> logs;
+
+        template<class Archive>
+        void serialize(Archive & archive)
+        {
+            archive(counts, logs);
+        }
+    };
+
+    unsigned m_window_time{ 0 };
+    std::size_t m_memory_cap{ 0 };
+    std::time_t m_bucket_time{ 0 };
+    std::size_t m_width{ 0 };
+    std::vector<std::time_t> m_bucket_start;
+    std::vector<std::uint32_t> m_counters;
+    std::map<std::string, exact_key> m_exact;
+    std::size_t m_exact_bytes{ 0 };
+    std::uint64_t m_cap_hits{ 0 };
+    bool m_capped{ false };
+
+    [[nodiscard]] bool in_window(std::time_t bucket_start, std::time_t now) const noexcept;
+    [[nodiscard]] std::array<std::size_t, DEPTH> cells(const std::string & key) const noexcept;
+    [[nodiscard]] std::uint32_t estimate(std::size_t bucket, const std::array<std::size_t, DEPTH> & cells) const noexcept;
+    [[nodiscard]] std::size_t exact_budget() const noexcept;
+    [[nodiscard]] bool store_log(exact_key & ek, const std::string & logstr, std::time_t now);
+    void expire(std::time_t now);
+};
+
+} /* namespace ctguard::research */
@@ -0,0 +1,27 @@
+#include "builtin_rules.hpp"
+
+#include <cstddef>
+
+#include "rule_cache.hpp"
+
+namespace ctguard::research {
+
+#ifdef CTGUARD_BUILTIN_RULES
+
+// defined by the source generated by ctguard-research-rulegen
+extern const unsigned char BUILTIN_RULES_DATA[];  // NOLINT(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+extern const std::size_t BUILTIN_RULES_SIZE;
+
+std::optional<rule_cfg> builtin_rules()
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return read_rule_image({ reinterpret_cast<const char *>(BUILTIN_RULES_DATA), BUILTIN_RULES_SIZE });
+}
+
+#else
+
+std::optional<rule_cfg> builtin_rules() { return std::nullopt; }
+
+#endif
+
+} /* namespace ctguard::research */
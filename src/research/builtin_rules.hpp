@@ -0,0 +1,12 @@
+#pragma once
+
+#include <optional>
+
+#include "rule.hpp"
+
+namespace ctguard::research {
+
+// The rule pack compiled into research at build time (cmake option ENABLE_BUILTIN_RULES), if any; throws on error.
+[[nodiscard]] std::optional<rule_cfg> builtin_rules();
+
+} /* namespace ctguard::research */
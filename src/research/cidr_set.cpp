@@ -0,0 +1,159 @@
+#include "cidr_set.hpp"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "../libs/parsehelper.hpp"
+
+namespace ctguard::research {
+
+static constexpr unsigned IPV4_MAPPED_OFFSET{ 96 };
+static constexpr std::uint64_t IPV4_MAPPED_MARKER{ 0xffffULL << 32U };
+
+static unsigned bit(const std::array<std::uint64_t, 2> & address, unsigned pos) noexcept
+{
+    return pos < 64 ? (address[0] >> (63 - pos)) & 1U : (address[1] >> (127 - pos)) & 1U;
+}
+
+static std::array<std::uint64_t, 2> mask(std::array<std::uint64_t, 2> address, unsigned len) noexcept
+{
+    if (len < 64) {
+        address[0] = len == 0 ? 0 : address[0] & ~((~0ULL) >> len);
+        address[1] = 0;
+    } else if (len < 128) {
+        address[1] = len == 64 ? 0 : address[1] & ~((~0ULL) >> (len - 64));
+    }
+    return address;
+}
+
+static unsigned common_len(const std::array<std::uint64_t, 2> & a, const std::array<std::uint64_t, 2> & b, unsigned max_len) noexcept
+{
+    unsigned result{ 128 };
+    if (const std::uint64_t x = a[0] ^ b[0]; x != 0) {
+        result = static_cast<unsigned>(__builtin_clzll(x));
+    } else if (const std::uint64_t y = a[1] ^ b[1]; y != 0) {
+        result = 64 + static_cast<unsigned>(__builtin_clzll(y));
+    }
+    return std::min(result, max_len);
+}
+
+static std::uint64_t load_be64(const unsigned char * bytes) noexcept
+{
+    std::uint64_t result{ 0 };
+    for (unsigned i = 0; i < 8; ++i) {
+        result = (result << 8U) | bytes[i];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    return result;
+}
+
+bool cidr_set::parse_address(std::string_view str, address_t & address, unsigned & max_len)
+{
+    // inet_pton needs a terminated string
+    const std::string terminated{ str };
+
+    std::array<unsigned char, 16> bytes;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    if (::inet_pton(AF_INET, terminated.c_str(), bytes.data()) == 1) {
+        address[0] = 0;
+        address[1] = IPV4_MAPPED_MARKER | (std::uint64_t{ bytes[0] } << 24U) | (std::uint64_t{ bytes[1] } << 16U) | (std::uint64_t{ bytes[2] } << 8U) | bytes[3];
+        max_len = 32;
+        return true;
+    }
+    if (::inet_pton(AF_INET6, terminated.c_str(), bytes.data()) == 1) {
+        address[0] = load_be64(bytes.data());
+        address[1] = load_be64(bytes.data() + 8);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        max_len = 128;
+        return true;
+    }
+
+    return false;
+}
+
+void cidr_set::add(std::string_view prefix)
+{
+    const auto slash = prefix.find('/');
+    address_t address;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    unsigned max_len;   // NOLINT(cppcoreguidelines-init-variables)
+    if (!parse_address(prefix.substr(0, slash), address, max_len)) {
+        throw std::out_of_range{ "Invalid address '" + std::string{ prefix.substr(0, slash) } + "'" };
+    }
+
+    unsigned len{ max_len };
+    if (slash != std::string_view::npos) {
+        len = libs::parse_integral<unsigned>(std::string{ prefix.substr(slash + 1) });
+        if (len > max_len) {
+            throw std::out_of_range{ "Invalid prefix length in '" + std::string{ prefix } + "'" };
+        }
+    }
+
+    insert(mask(address, (max_len == 32 ? IPV4_MAPPED_OFFSET : 0) + len), (max_len == 32 ? IPV4_MAPPED_OFFSET : 0) + len);
+}
+
+void cidr_set::insert(const address_t & address, unsigned len)
+{
+    std::uint32_t current{ 0 };
+    while (true) {
+        // invariant: address matches the prefix of the current node and len >= its length
+        if (len == m_nodes[current].len) {
+            m_nodes[current].terminal = true;
+            return;
+        }
+
+        const unsigned branch = bit(address, m_nodes[current].len);
+        const std::uint32_t child = m_nodes[current].children[branch];
+        if (child == 0) {
+            const auto leaf = static_cast<std::uint32_t>(m_nodes.size());
+            m_nodes.push_back(node{ address, static_cast<std::uint8_t>(len), true, { 0, 0 } });
+            m_nodes[current].children[branch] = leaf;
+            return;
+        }
+
+        const unsigned common = common_len(address, m_nodes[child].prefix, std::min<unsigned>(len, m_nodes[child].len));
+        if (common == m_nodes[child].len) {
+            current = child;
+            continue;
+        }
+
+        // split the edge to child at the first differing bit
+        const auto middle = static_cast<std::uint32_t>(m_nodes.size());
+        m_nodes.push_back(node{ mask(address, common), static_cast<std::uint8_t>(common), common == len, { 0, 0 } });
+        m_nodes[middle].children[bit(m_nodes[child].prefix, common)] = child;
+        if (common < len) {
+            const auto leaf = static_cast<std::uint32_t>(m_nodes.size());
+            m_nodes.push_back(node{ address, static_cast<std::uint8_t>(len), true, { 0, 0 } });
+            m_nodes[middle].children[bit(address, common)] = leaf;
+        }
+        m_nodes[current].children[branch] = middle;
+        return;
+    }
+}
+
+bool cidr_set::contains(std::string_view address_str) const
+{
+    address_t address;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    unsigned max_len;   // NOLINT(cppcoreguidelines-init-variables)
+    if (!parse_address(address_str, address, max_len)) {
+        return false;
+    }
+
+    std::uint32_t current{ 0 };
+    while (true) {
+        const node & n = m_nodes[current];
+        if (common_len(address, n.prefix, n.len) < n.len) {
+            return false;
+        }
+        if (n.terminal) {
+            return true;
+        }
+        if (n.len == 128) {
+            return false;
+        }
+        current = n.children[bit(address, n.len)];
+        if (current == 0) {
+            return false;
+        }
+    }
+}
+
+} /* namespace ctguard::research */
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ctguard::research {
+
+// Set of IPv4 and IPv6 prefixes in a path compressed binary radix tree.
+// IPv4 addresses are stored as IPv4-mapped IPv6 addresses (::ffff:0:0/96).
+// A lookup is a single walk from the root, comparing whole compressed prefixes per node.
+class cidr_set
+{
+  public:
+    // Add a prefix like '10.0.0.0/8', '2001:db8::/32' or a single address; throws on invalid input.
+    void add(std::string_view prefix);
+
+    // Returns whether address is covered by any prefix; invalid addresses never match.
+    [[nodiscard]] bool contains(std::string_view address) const;
+
+    [[nodiscard]] bool empty() const noexcept { return m_nodes.size() <= 1; }
+
+    template<class Archive>
+    void serialize(Archive & archive)
+    {
+        archive(m_nodes);
+    }
+
+  private:
+    using address_t = std::array<std::uint64_t, 2>;
+
+    struct node
+    {
+        address_t prefix{ 0, 0 };  // bits beyond len are zero
+        std::uint8_t len{ 0 };
+        bool terminal{ false };
+        std::array<std::uint32_t, 2> children{ 0, 0 };  // 0 is the root, so never a child
+
+        template<class Archive>
+        void serialize(Archive & archive)
+        {
+            archive(prefix, len, terminal, children);
+        }
+    };
+
+    std::vector<node> m_nodes{ node{} };
+
+    static bool parse_address(std::string_view str, address_t & address, unsigned & max_len);
+    void insert(const address_t & address, unsigned len);
+};
+
+} /* namespace ctguard::research */
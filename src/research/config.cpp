@@ -2,6 +2,7 @@
 
 #include <cstring>    // strerror
 #include <fstream>    // std::ifstream
+#include <sstream>    // std::ostringstream
 #include <stdexcept>  // std::runtime_error
 
 #include "../libs/config/parser.hpp"
@@ -47,6 +48,20 @@ research_config parse_config(const std::string & cfg_path)
                 }
                 cfg.rules_directory = a.second.options[0];
 
+            } else if (a.first == "builtin_rules") {
+                try {
+                    cfg.builtin_rules = libs::parse_bool(a.second.options[0]);
+                } catch (const std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+
+            } else if (a.first == "rules_cache") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+                cfg.rules_cache = a.second.options[0];
+
             } else if (a.first == "log_path") {
                 if (a.second.options.size() != 1) {
                     throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
@@ -81,6 +96,123 @@ research_config parse_config(const std::string & cfg_path)
                     throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
                 }
 
+            } else if (a.first == "state_file") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+                cfg.state_file = a.second.options[0];
+
+            } else if (a.first == "state_file_interval") {
+                try {
+                    cfg.state_file_interval = libs::parse_second_duration(a.second.options);
+                } catch (const std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+                if (cfg.state_file_interval == 0) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: must be positive" };
+                }
+
+            } else if (a.first == "suppress_max_entries") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+
+                try {
+                    cfg.suppress_max_entries = libs::parse_integral<std::size_t>(a.second.options[0]);
+                } catch (std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+                if (cfg.suppress_max_entries == 0) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: must be positive" };
+                }
+
+            } else if (a.first == "regex_max_length") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+
+                try {
+                    cfg.regex_max_length = libs::parse_integral<std::size_t>(a.second.options[0]);
+                } catch (std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+                if (cfg.regex_max_length == 0) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: must be positive" };
+                }
+
+            } else if (a.first == "regex_budget") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+
+                try {
+                    cfg.regex_budget = libs::parse_integral<unsigned>(a.second.options[0]);
+                } catch (std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+                if (cfg.regex_budget == 0) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: must be positive" };
+                }
+
+            } else if (a.first == "slow_rule_threshold") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+
+                try {
+                    cfg.slow_rule_threshold = libs::parse_integral<unsigned>(a.second.options[0]);
+                } catch (std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+                if (cfg.slow_rule_threshold == 0) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: must be positive" };
+                }
+
+            } else if (a.first == "slow_rule_report_interval") {
+                try {
+                    cfg.slow_rule_report_interval = libs::parse_second_duration(a.second.options);
+                } catch (const std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+                if (cfg.slow_rule_report_interval == 0) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: must be positive" };
+                }
+
+            } else if (a.first == "queue_high_water") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+
+                try {
+                    cfg.queue_high_water = libs::parse_integral<std::size_t>(a.second.options[0]);
+                } catch (std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+
+            } else if (a.first == "shed_sample_rate") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+
+                try {
+                    cfg.shed_sample_rate = libs::parse_integral<unsigned>(a.second.options[0]);
+                } catch (std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+                if (cfg.shed_sample_rate == 0) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: must be positive" };
+                }
+
+            } else if (a.first == "shed_domains") {
+                cfg.shed_domains = a.second.options;
+
             } else if (a.first == "mail") {
                 try {
                     cfg.mail = libs::parse_bool(a.second.options[0]);
@@ -95,6 +227,13 @@ research_config parse_config(const std::string & cfg_path)
                     throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
                 }
 
+            } else if (a.first == "mail_keepalive") {
+                try {
+                    cfg.mail_keepalive = libs::parse_second_duration(a.second.options);
+                } catch (const std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+
             } else if (a.first == "mail_sample_time") {
                 try {
                     cfg.mail_sample_time = libs::parse_second_duration(a.second.options);
@@ -194,6 +333,28 @@ research_config parse_config(const std::string & cfg_path)
                     throw std::out_of_range{ "Invalid argument for configuration " + a.first + " given: '" + a.second.options[0] + "'" };
                 }
 
+            } else if (a.first == "intervention_dedup_time") {
+                try {
+                    cfg.intervention_dedup_time = libs::parse_second_duration(a.second.options);
+                } catch (const std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+
+            } else if (a.first == "intervention_dedup_max_entries") {
+                if (a.second.options.size() != 1) {
+                    throw std::out_of_range{ "Invalid number of arguments for configuration " + a.first +
+                                             " given: " + std::to_string(a.second.options.size()) };
+                }
+
+                try {
+                    cfg.intervention_dedup_max_entries = libs::parse_integral<std::size_t>(a.second.options[0]);
+                } catch (std::exception & e) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: " + e.what() };
+                }
+                if (cfg.intervention_dedup_max_entries == 0) {
+                    throw std::out_of_range{ "Invalid argument '" + a.second.options[0] + "' for configuration " + a.first + " given: must be positive" };
+                }
+
             } else {
                 throw std::out_of_range{ "Invalid configuration option '" + a.first + "' in group research at " + to_string(a.second.pos) };
             }
@@ -225,10 +386,22 @@ std::ostream & operator<<(std::ostream & out, intervention_kind_t ik)
     return out;
 }
 
+static std::string dump_list(const std::vector<std::string> & list)
+{
+    std::ostringstream oss;
+    for (const auto & elem : list) {
+        oss << elem << ", ";
+    }
+    return oss.str();
+}
+
 std::ostream & operator<<(std::ostream & out, const research_config & cfg)
 {
     out << "START config dump\n"
+        << "    builtin_rules:        " << cfg.builtin_rules << "\n"
         << "    input_path:           " << cfg.input_path << "\n"
+        << "    intervention_dedup_max_entries: " << cfg.intervention_dedup_max_entries << "\n"
+        << "    intervention_dedup_time: " << cfg.intervention_dedup_time << "\n"
         << "    intervention_kind     " << cfg.intervention_kind << "\n"
         << "    intervention_path     " << cfg.intervention_path << "\n"
         << "    log_path:             " << cfg.log_path << "\n"
@@ -237,6 +410,7 @@ std::ostream & operator<<(std::ostream & out, const research_config & cfg)
         << "    mail_host             " << cfg.mail_host << "\n"
         << "    mail_instant          " << cfg.mail_instant << "\n"
         << "    mail_interval         " << cfg.mail_interval << "\n"
+        << "    mail_keepalive        " << cfg.mail_keepalive << "\n"
         << "    mail_max_sample_count " << cfg.mail_max_sample_count << "\n"
         << "    mail_port             " << cfg.mail_port << "\n"
         << "    mail_priority         " << cfg.mail_priority << "\n"
@@ -244,8 +418,19 @@ std::ostream & operator<<(std::ostream & out, const research_config & cfg)
         << "    mail_sample_time      " << cfg.mail_sample_time << "\n"
         << "    mail_toaddr           " << cfg.mail_toaddr << "\n"
         << "    output_path:          " << cfg.output_path << "\n"
+        << "    queue_high_water:     " << cfg.queue_high_water << "\n"
+        << "    regex_budget:         " << cfg.regex_budget << "\n"
+        << "    regex_max_length:     " << cfg.regex_max_length << "\n"
+        << "    rules_cache:          " << cfg.rules_cache << "\n"
         << "    rules_directory:      " << cfg.rules_directory << "\n"
         << "    rules_file:           " << cfg.rules_file << "\n"
+        << "    shed_domains:         " << dump_list(cfg.shed_domains) << "\n"
+        << "    shed_sample_rate:     " << cfg.shed_sample_rate << "\n"
+        << "    slow_rule_report_interval: " << cfg.slow_rule_report_interval << "\n"
+        << "    slow_rule_threshold:  " << cfg.slow_rule_threshold << "\n"
+        << "    state_file:           " << cfg.state_file << "\n"
+        << "    state_file_interval:  " << cfg.state_file_interval << "\n"
+        << "    suppress_max_entries: " << cfg.suppress_max_entries << "\n"
         << "END config dump\n";
 
     return out;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace ctguard::research {
 
@@ -16,15 +17,30 @@ struct research_config
 {
     std::string rules_file{ "" };
     std::string rules_directory{ "/etc/ctguard/rules/" };
+    bool builtin_rules{ false };
+    std::string rules_cache{ "/var/lib/ctguard/research.rules.cache" };
     std::string log_path{ "/var/log/ctguard/research.log" };
     std::string output_path{ "/var/log/ctguard/alerts.log" };
     std::string input_path{ "/run/ctguard/research.sock" };
     std::string intervention_path{ "/run/ctguard_intervention.sock" };
     intervention_kind_t intervention_kind{ intervention_kind_t::SOCKET };
+    unsigned intervention_dedup_time{ 300 };
+    std::size_t intervention_dedup_max_entries{ 10000 };
     priority_t log_priority{ 1 };
+    std::string state_file{ "/var/lib/ctguard/research.state" };
+    unsigned state_file_interval{ 60 };
+    std::size_t suppress_max_entries{ 10000 };
+    std::size_t regex_max_length{ 4096 };
+    unsigned regex_budget{ 100 };        // ms
+    unsigned slow_rule_threshold{ 10 };  // ms
+    unsigned slow_rule_report_interval{ 300 };
+    std::size_t queue_high_water{ 100000 };
+    unsigned shed_sample_rate{ 10 };
+    std::vector<std::string> shed_domains;
 
     bool mail{ true };
     unsigned mail_interval{ 30 };
+    unsigned mail_keepalive{ 60 };
     unsigned mail_sample_time{ 1 };
     unsigned mail_max_sample_count{ 1000 };
     priority_t mail_priority{ 4 };
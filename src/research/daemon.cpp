@@ -6,14 +6,19 @@
 #include <unistd.h>  // ::close
 
 #include <csignal>
+#include <future>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <sstream>
 #include <stack>
 #include <string>
 #include <thread>
 
 #include <cereal/archives/binary.hpp>
+#include <cereal/types/map.hpp>
 #include <cereal/types/memory.hpp>
+#include <cereal/types/string.hpp>
 
 #include "../libs/blockedqueue.hpp"
 #include "../libs/errnoexception.hpp"
@@ -21,10 +26,14 @@
 #include "../libs/scopeguard.hpp"
 
 #include "event.hpp"
+#include "intervention_cache.hpp"
 #include "intervention_sink.hpp"
+#include "load_shedder.hpp"
 #include "process_log.hpp"
 #include "research.hpp"
 #include "send_mail.hpp"
+#include "state_file.hpp"
+#include "suppress.hpp"
 
 namespace ctguard::research {
 
@@ -46,20 +55,83 @@ static std::string raw_2_str(const char * str, std::size_t length)
     return oss.str();
 }
 
+static void collect_rule_ids(const std::vector<rule> & rules, std::set<rule_id_t> & ids)
+{
+    for (const auto & rl : rules) {
+        ids.insert(rl.id());
+        collect_rule_ids(rl.children(), ids);
+    }
+}
+
+static void collect_suppress_rules(const std::vector<rule> & rules, std::map<rule_id_t, struct suppress_rule> & suppress_rules)
+{
+    for (const auto & rl : rules) {
+        if (rl.suppress().time != 0) {
+            suppress_rules.emplace(rl.id(), rl.suppress());
+        }
+        collect_suppress_rules(rl.children(), suppress_rules);
+    }
+}
+
+// Drop the correlation state of rules no longer present after a reload.
+// Entries are only reset, not erased, cause the state task iterates the map concurrently.
+static void prune_rules_state(const rule_cfg & rules, std::map<rule_id_t, struct rule_state> & rules_state)
+{
+    std::set<rule_id_t> ids;
+    collect_rule_ids(rules.std_rules, ids);
+    collect_rule_ids(rules.group_rules, ids);
+
+    for (auto & iter : rules_state) {
+        if (ids.find(iter.first) != ids.end()) {
+            continue;
+        }
+
+        std::lock_guard lg{ iter.second.mutex };
+        if (!iter.second.mevents.empty() || iter.second.unless_triggered != 0 || !iter.second.approx.empty() || !iter.second.distinct.empty()) {
+            FILE_LOG(libs::log_level::DEBUG) << "[pw] dropping state of removed rule " << iter.first;
+        }
+        iter.second.mevents.clear();
+        iter.second.unless_triggered = 0;
+        iter.second.approx = approx_window{};
+        iter.second.distinct = distinct_window{};
+        iter.second.dirty = true;
+    }
+}
+
 static void processing_task(libs::blocked_queue<libs::source_event> & input, libs::blocked_queue<event> & alert_output,
-                            libs::blocked_queue<intervention_t> & intervention_queue, const research_config & cfg, const rule_cfg & rules,
-                            std::map<rule_id_t, struct rule_state> & rules_state, errorstack_t & es)
+                            libs::blocked_queue<intervention_t> & intervention_queue, const research_config & cfg,
+                            const std::shared_ptr<const rule_cfg> & current_rules, std::map<rule_id_t, struct rule_state> & rules_state,
+                            alert_suppressor & suppressor, intervention_cache & dispatched, regex_guard & guard, errorstack_t & es)
 {
     FILE_LOG(libs::log_level::DEBUG) << "[pw] started.";
     libs::scope_guard sg{ []() { FILE_LOG(libs::log_level::DEBUG) << "[pw] stopped."; } };
 
     try {
+        const rule_cfg * last_rules{ nullptr };
+        std::map<rule_id_t, struct suppress_rule> suppress_rules;
         for (;;) {
             libs::source_event se{ input.take() };
 
+            // hold a reference for the whole event, so a concurrent reload can not free the rules in use
+            const std::shared_ptr<const rule_cfg> rules{ std::atomic_load(&current_rules) };
+            if (rules.get() != last_rules) {
+                if (last_rules != nullptr) {
+                    FILE_LOG(libs::log_level::DEBUG) << "[pw] switching to reloaded rules";
+                    prune_rules_state(*rules, rules_state);
+                }
+                last_rules = rules.get();
+
+                suppress_rules.clear();
+                collect_suppress_rules(rules->std_rules, suppress_rules);
+                collect_suppress_rules(rules->group_rules, suppress_rules);
+            }
+
             FILE_LOG(libs::log_level::DEBUG) << "[pw] input message: '" << se.message << "'";
 
             if (se.control_message && se.message == "!KILL") {
+                for (auto & summary : suppressor.flush()) {
+                    alert_output.push(std::move(summary));
+                }
                 event e{ se };
                 alert_output.emplace(e);
                 intervention_t tmp{ "", "", true };
@@ -67,15 +139,22 @@ static void processing_task(libs::blocked_queue<libs::source_event> & input, lib
                 return;
             }
 
-            event e{ process_log(se, false, rules, rules_state) };
+            event e{ process_log(se, false, *rules, rules_state, guard) };
 
             if (e.priority() >= cfg.log_priority || e.always_alert()) {
+                if (const auto sr = suppress_rules.find(e.rule_id()); sr != suppress_rules.end() && !suppressor.check(e, sr->second, std::time(nullptr))) {
+                    FILE_LOG(libs::log_level::DEBUG) << "[pw] event suppressed";
+                    continue;
+                }
+
                 for (const auto & intervention : e.interventions()) {
                     if (e.fields().find(intervention.field) == e.fields().end()) {
                         if (!intervention.ignore_empty_field) {
                             FILE_LOG(libs::log_level::WARNING)
                               << "Empty argument '" << intervention.field << "' for intervention '" << intervention.name << "' by rule " << e.rule_id();
                         }
+                    } else if (!dispatched.check(intervention.name, e.fields()[intervention.field], std::time(nullptr))) {
+                        FILE_LOG(libs::log_level::DEBUG) << "[pw] intervention '" << intervention.name << "' suppressed as recently dispatched";
                     } else {
                         intervention_t tmp{ intervention.name, e.fields()[intervention.field], false };
                         intervention_queue.emplace(std::move(tmp));
@@ -94,13 +173,45 @@ static void processing_task(libs::blocked_queue<libs::source_event> & input, lib
     }
 }
 
-static void state_task(const research_config & cfg, std::map<rule_id_t, struct rule_state> & rules_state, libs::blocked_queue<event> & output,
+static void save_state(const research_config & cfg, std::map<rule_id_t, struct rule_state> & rules_state, state_snapshot & snapshot)
+{
+    try {
+        const std::size_t updated = snapshot.update(rules_state);
+        FILE_LOG(libs::log_level::DEBUG) << "Saving state (" << updated << " modified entries)...";
+        snapshot.write(cfg.state_file);
+    } catch (const std::exception & e) {
+        FILE_LOG(libs::log_level::ERROR) << "Can not save state: " << e.what();
+        FILE_LOG(libs::log_level::WARNING) << "State not saved to disk";
+    }
+}
+
+static void report_slow_rules(const research_config & cfg, regex_guard & guard)
+{
+    const auto [slow, exceeded_events] = guard.take_report();
+    for (const auto & iter : slow) {
+        if (iter.second.count != 0) {
+            FILE_LOG(libs::log_level::WARNING) << "Slow regex evaluation of " << iter.first << ": " << iter.second.count << " times over "
+                                               << cfg.slow_rule_threshold << "ms (max " << iter.second.max.count() / 1000 << "ms)";
+        }
+        if (iter.second.errors != 0) {
+            FILE_LOG(libs::log_level::WARNING) << "Regex evaluation of " << iter.first << " failed " << iter.second.errors << " times";
+        }
+    }
+    if (exceeded_events != 0) {
+        FILE_LOG(libs::log_level::WARNING) << exceeded_events << " events exceeded the regex budget of " << cfg.regex_budget << "ms";
+    }
+}
+
+static void state_task(const research_config & cfg, std::map<rule_id_t, struct rule_state> & rules_state, state_snapshot & snapshot,
+                       alert_suppressor & suppressor, intervention_cache & dispatched, regex_guard & guard, libs::blocked_queue<event> & output,
                        errorstack_t & es)
 {
     FILE_LOG(libs::log_level::DEBUG) << "[st] started.";
     libs::scope_guard sg{ []() { FILE_LOG(libs::log_level::DEBUG) << "[st] stopped."; } };
 
     try {
+        std::time_t last_save{ std::time(nullptr) };
+        std::time_t last_report{ std::time(nullptr) };
         while (RUNNING) {
             FILE_LOG(libs::log_level::DEBUG2) << "[st] sleeping...";
             std::this_thread::sleep_for(std::chrono::milliseconds(500));
@@ -112,6 +223,7 @@ static void state_task(const research_config & cfg, std::map<rule_id_t, struct r
                     if (iter.second.unless_triggered + iter.second.unless_timeout < std::time(nullptr)) {
                         FILE_LOG(libs::log_level::DEBUG) << "[st] unless triggered...";
                         iter.second.unless_triggered = 0;
+                        iter.second.dirty = true;
 
                         if (iter.second.unless_event.priority() >= cfg.log_priority || iter.second.unless_event.always_alert()) {
                             output.emplace(iter.second.unless_event);
@@ -119,6 +231,23 @@ static void state_task(const research_config & cfg, std::map<rule_id_t, struct r
                     }
                 }
             }
+
+            for (auto & summary : suppressor.expire(std::time(nullptr))) {
+                FILE_LOG(libs::log_level::DEBUG) << "[st] suppression window of rule " << summary.rule_id() << " closed";
+                output.push(std::move(summary));
+            }
+
+            dispatched.expire(std::time(nullptr));
+
+            if (!cfg.state_file.empty() && last_save + cfg.state_file_interval <= std::time(nullptr)) {
+                save_state(cfg, rules_state, snapshot);
+                last_save = std::time(nullptr);
+            }
+
+            if (last_report + cfg.slow_rule_report_interval <= std::time(nullptr)) {
+                report_slow_rules(cfg, guard);
+                last_report = std::time(nullptr);
+            }
         }
 
     } catch (...) {
@@ -253,65 +382,38 @@ struct summary_item
     priority_t priority;
 };
 
-static void send_mail_queue(const research_config & cfg, const std::vector<event> & q)
+static void send_mail_queue(const research_config & cfg, smtp_session & session, const std::vector<event> & q)
 {
-    std::ostringstream mail;
-    std::ostringstream content;
-    priority_t max_alert{ 0 };
-
-    mail << "                        ######################\n"
-         << "                        # ctguard alert mail #\n"
-         << "                        #   " << std::setw(4) << q.size() << " alert" << (q.size() == 1 ? ' ' : 's') << "      #\n"
-         << "                        ######################\n\n";
-
     std::map<std::string, summary_item> summary_map;
     std::size_t interventions{ 0 };
     std::map<std::string, unsigned> interventions_details;
+    priority_t max_alert{ 0 };
 
+    // summarize first, so the alerts can be streamed to the mail server afterwards
     for (const auto & ev : q) {
         summary_map[ev.description()].id = ev.rule_id();
         summary_map[ev.description()].priority = ev.priority();
         summary_map[ev.description()].count++;
 
-        content << "#=========================== ALERT START ===========================#\n\n"
-                << "  - Info:             " << ev.description() << " (id: " << ev.rule_id() << ")\n\n"
-                << "  - Priority:        " << std::setw(2) << ev.priority() << "\n\n";
-
-        if (!ev.interventions().empty()) {
-            interventions += ev.interventions().size();
-            content << "  - Intervention:\n";
-            for (const auto & it : ev.interventions()) {
-                interventions_details[it.name]++;
-                const auto it_arg = ev.fields().find(it.field);
-                if (it_arg != ev.fields().end()) {
-                    content << "           " << std::setw(20) << it.name << " ( " << it.field << " :: " << it_arg->second << " )\n";
-                } else {
-                    content << "           " << std::setw(20) << it.name << " ( " << it.field << " :: !EMPTY! )\n";
-                }
-            }
+        interventions += ev.interventions().size();
+        for (const auto & it : ev.interventions()) {
+            interventions_details[it.name]++;
         }
 
-        content << "\n  - Log start\n    > " << ev.logstr() << "\n  - Log end\n\n"
-                << "  - Traits:\n";
-
-        for (const auto & iter : ev.traits()) {
-            content << "           " << std::setw(20) << iter.first << " :: " << iter.second << "\n";
-        }
-
-        if (!ev.fields().empty()) {
-            content << "  - Extracted fields:\n";
-            for (const auto & iter : ev.fields()) {
-                content << "           " << std::setw(20) << iter.first << " :: " << iter.second << "\n";
-            }
-        }
-
-        content << "\n#============================ ALERT END ============================#\n\n";
-
         if (ev.priority() > max_alert) {
             max_alert = ev.priority();
         }
     }
 
+    std::ostream & mail = session.start_mail(cfg.mail_fromaddr, cfg.mail_toaddr,
+                                             "ctguard :: " + std::to_string(q.size()) + " alert(s) :: max priority " + std::to_string(max_alert),
+                                             cfg.mail_replyaddr);
+
+    mail << "                        ######################\n"
+         << "                        # ctguard alert mail #\n"
+         << "                        #   " << std::setw(4) << q.size() << " alert" << (q.size() == 1 ? ' ' : 's') << "      #\n"
+         << "                        ######################\n\n";
+
     mail << "#============================= SUMMARY =============================#\n\n";
 
     for (const auto & iter : summary_map) {
@@ -334,15 +436,46 @@ static void send_mail_queue(const research_config & cfg, const std::vector<event
 
     mail << "\n#============================= SUMMARY =============================#\n\n";
 
-    mail << content.str();
+    for (const auto & ev : q) {
+        mail << "#=========================== ALERT START ===========================#\n\n"
+             << "  - Info:             " << ev.description() << " (id: " << ev.rule_id() << ")\n\n"
+             << "  - Priority:        " << std::setw(2) << ev.priority() << "\n\n";
+
+        if (!ev.interventions().empty()) {
+            mail << "  - Intervention:\n";
+            for (const auto & it : ev.interventions()) {
+                const auto it_arg = ev.fields().find(it.field);
+                if (it_arg != ev.fields().end()) {
+                    mail << "           " << std::setw(20) << it.name << " ( " << it.field << " :: " << it_arg->second << " )\n";
+                } else {
+                    mail << "           " << std::setw(20) << it.name << " ( " << it.field << " :: !EMPTY! )\n";
+                }
+            }
+        }
+
+        mail << "\n  - Log start\n    > " << ev.logstr() << "\n  - Log end\n\n"
+             << "  - Traits:\n";
+
+        for (const auto & iter : ev.traits()) {
+            mail << "           " << std::setw(20) << iter.first << " :: " << iter.second << "\n";
+        }
+
+        if (!ev.fields().empty()) {
+            mail << "  - Extracted fields:\n";
+            for (const auto & iter : ev.fields()) {
+                mail << "           " << std::setw(20) << iter.first << " :: " << iter.second << "\n";
+            }
+        }
+
+        mail << "\n#============================ ALERT END ============================#\n\n";
+    }
 
     mail << "                        ######################\n"
          << "                        # ctguard alert mail #\n"
          << "                        #   " << std::setw(4) << q.size() << " alert" << (q.size() == 1 ? ' ' : 's') << "      #\n"
          << "                        ######################\n\n";
 
-    send_mail(cfg.mail_host, cfg.mail_port, cfg.mail_fromaddr, cfg.mail_toaddr,
-              "ctguard :: " + std::to_string(q.size()) + " alert(s) :: max priority " + std::to_string(max_alert), cfg.mail_replyaddr, mail.str());
+    session.finish_mail();
 }
 
 static void mail_task(const research_config & cfg, libs::blocked_queue<event> & mail_queue, errorstack_t & es)
@@ -351,6 +484,7 @@ static void mail_task(const research_config & cfg, libs::blocked_queue<event> &
     libs::scope_guard sg{ []() { FILE_LOG(libs::log_level::DEBUG) << "[mq] stopped."; } };
 
     try {
+        smtp_session session{ cfg.mail_host, cfg.mail_port, cfg.mail_keepalive };
         std::vector<event> local_queue;
         priority_t max_priority{ 0 };
         std::time_t last_send{ 0 };
@@ -377,7 +511,7 @@ static void mail_task(const research_config & cfg, libs::blocked_queue<event> &
                 if (!local_queue.empty()) {
                     try {
                         last_send = std::time(nullptr);
-                        send_mail_queue(cfg, local_queue);
+                        send_mail_queue(cfg, session, local_queue);
                         local_queue = std::vector<event>();
                         max_priority = 0;
                     } catch (const std::exception & e) {
@@ -385,11 +519,13 @@ static void mail_task(const research_config & cfg, libs::blocked_queue<event> &
                     }
                 }
             }
+
+            session.idle(std::time(nullptr));
         }
 
         if (!local_queue.empty()) {
             try {
-                send_mail_queue(cfg, local_queue);
+                send_mail_queue(cfg, session, local_queue);
                 local_queue = std::vector<event>();
             } catch (const std::exception & e) {
                 FILE_LOG(libs::log_level::ERROR) << "Can not send alert mail: " << e.what();
@@ -406,7 +542,7 @@ static void mail_task(const research_config & cfg, libs::blocked_queue<event> &
     }
 }
 
-static void input_task(libs::blocked_queue<libs::source_event> & output, const std::string & input_path, errorstack_t & es)
+static void input_task(libs::blocked_queue<libs::source_event> & output, const std::string & input_path, load_shedder & shedder, errorstack_t & es)
 {
     FILE_LOG(libs::log_level::DEBUG) << "[iw] started.";
     libs::scope_guard sg{ []() { FILE_LOG(libs::log_level::DEBUG) << "[iw] stopped."; } };
@@ -447,6 +583,11 @@ static void input_task(libs::blocked_queue<libs::source_event> & output, const s
             FILE_LOG(libs::log_level::DEBUG2) << "[iw] waiting for connection...";
 
             do {
+                if (auto report = shedder.report(output.size(), std::time(nullptr)); report) {
+                    FILE_LOG(libs::log_level::WARNING) << "[iw] " << report->message;
+                    output.emplace(std::move(*report));
+                }
+
                 std::array<char, 16384> buffer;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
                 ssize_t n = ::recv(socket, buffer.data(), buffer.size(), 0);
                 if (n <= 0) {
@@ -483,7 +624,13 @@ static void input_task(libs::blocked_queue<libs::source_event> & output, const s
                     if (se.control_message && se.message == "!KILL") {
                         FILE_LOG(libs::log_level::WARNING) << "[iw] Ignoring external kill message";
                     } else {
-                        output.emplace(se);
+                        const bool was_shedding = shedder.shedding();
+                        if (shedder.admit(se, output.size())) {
+                            output.emplace(se);
+                        }
+                        if (!was_shedding && shedder.shedding()) {
+                            FILE_LOG(libs::log_level::WARNING) << "[iw] Input queue reached its high water mark; shedding load";
+                        }
                     }
                 } catch (const std::exception & e) {
                     FILE_LOG(libs::log_level::ERROR) << "[iw] Can not decode message: " << e.what();
@@ -504,7 +651,34 @@ static void input_task(libs::blocked_queue<libs::source_event> & output, const s
     }
 }
 
-void daemon(const research_config & cfg, const rule_cfg & rules, std::ostream & output)
+static void log_stats(const libs::blocked_queue<libs::source_event> & input_queue, const load_shedder & shedder, const intervention_cache & dispatched)
+{
+    const auto stats = dispatched.get_stats();
+    FILE_LOG(libs::log_level::INFO) << "Statistics: input queue " << input_queue.size() << " events, " << shedder.total_shed() << " events shed";
+    FILE_LOG(libs::log_level::INFO) << "Statistics: interventions " << stats.dispatched << " dispatched, " << stats.suppressed << " suppressed as repeats, "
+                                    << stats.entries << " cached, " << stats.evicted << " evicted from cache";
+}
+
+static void reload_rules(const research_config & cfg, std::shared_ptr<const rule_cfg> & current_rules)
+{
+    FILE_LOG(libs::log_level::INFO) << "Reloading rules...";
+
+    try {
+        rules_load_stats stats;
+        auto rules = std::make_shared<const rule_cfg>(load_rules(cfg, &stats));
+        if (rules->std_rules.empty() && rules->group_rules.empty()) {
+            FILE_LOG(libs::log_level::ERROR) << "Can not reload rules: no rules loaded; keeping current rules";
+            return;
+        }
+
+        std::atomic_store(&current_rules, std::shared_ptr<const rule_cfg>{ std::move(rules) });
+        FILE_LOG(libs::log_level::INFO) << "Rules reloaded (" << (stats.builtin ? "builtin" : stats.from_cache ? "from cache" : "parsed") << " in " << stats.duration.count() << "ms)";
+    } catch (const std::exception & e) {
+        FILE_LOG(libs::log_level::ERROR) << "Can not reload rules: " << e.what() << "; keeping current rules";
+    }
+}
+
+void daemon(const research_config & cfg, std::shared_ptr<const rule_cfg> rules, std::ostream & output)
 {
     libs::blocked_queue<libs::source_event> input_queue;
     libs::blocked_queue<event> output_queue;
@@ -512,15 +686,51 @@ void daemon(const research_config & cfg, const rule_cfg & rules, std::ostream &
     libs::blocked_queue<intervention_t> intervention_queue;
     errorstack_t errorstack;
     std::map<rule_id_t, struct rule_state> rules_state;
+    state_snapshot snapshot;
+    alert_suppressor suppressor{ cfg.suppress_max_entries };
+    regex_guard guard{ cfg.regex_max_length, std::chrono::milliseconds{ cfg.regex_budget }, std::chrono::milliseconds{ cfg.slow_rule_threshold } };
+    intervention_cache dispatched{ cfg.intervention_dedup_time, cfg.intervention_dedup_max_entries };
+    load_shedder shedder{ cfg.queue_high_water, cfg.shed_sample_rate, { cfg.shed_domains.begin(), cfg.shed_domains.end() } };
 
     libs::scope_guard endmsg{ []() { FILE_LOG(libs::log_level::INFO) << "research stopped"; } };
 
+    if (!cfg.state_file.empty()) {
+        try {
+            if (load_state(cfg.state_file, rules_state)) {
+                prune_rules_state(*rules, rules_state);
+                FILE_LOG(libs::log_level::INFO) << "Restored correlation state of " << rules_state.size() << " rules";
+            } else {
+                FILE_LOG(libs::log_level::INFO) << "No state file; clean start";
+            }
+        } catch (const std::exception & e) {
+            FILE_LOG(libs::log_level::ERROR) << "Can not restore state file '" << cfg.state_file << "': " << e.what();
+            FILE_LOG(libs::log_level::WARNING) << "Ignoring state file; clean start";
+            rules_state.clear();
+        }
+    }
+
+    // block the handled signals before spawning threads, so they are only received by sigtimedwait()
+    sigset_t signal_set;
+    sigemptyset(&signal_set);
+    sigaddset(&signal_set, SIGINT);
+    sigaddset(&signal_set, SIGTERM);
+    sigaddset(&signal_set, SIGHUP);
+    sigaddset(&signal_set, SIGUSR1);
+    sigprocmask(SIG_SETMASK, &signal_set, nullptr);
+    const struct timespec timeout
+    {
+        1, 0
+    };  // 1s
+    siginfo_t info;
+
     FILE_LOG(libs::log_level::DEBUG) << "starting threads...";
 
-    auto input_thread = std::thread(input_task, std::ref(input_queue), std::cref(cfg.input_path), std::ref(errorstack));
+    auto input_thread = std::thread(input_task, std::ref(input_queue), std::cref(cfg.input_path), std::ref(shedder), std::ref(errorstack));
     auto processing_thread = std::thread(processing_task, std::ref(input_queue), std::ref(output_queue), std::ref(intervention_queue), std::cref(cfg),
-                                         std::cref(rules), std::ref(rules_state), std::ref(errorstack));
-    auto state_thread = std::thread(state_task, std::cref(cfg), std::ref(rules_state), std::ref(output_queue), std::ref(errorstack));
+                                         std::cref(rules), std::ref(rules_state), std::ref(suppressor), std::ref(dispatched), std::ref(guard),
+                                         std::ref(errorstack));
+    auto state_thread = std::thread(state_task, std::cref(cfg), std::ref(rules_state), std::ref(snapshot), std::ref(suppressor), std::ref(dispatched),
+                                    std::ref(guard), std::ref(output_queue), std::ref(errorstack));
     auto output_thread = std::thread(output_task, std::cref(cfg), std::ref(output_queue), std::ref(mail_queue), std::ref(output), std::ref(errorstack));
     auto intervention_thread = std::thread(intervention_task, std::cref(cfg), std::ref(intervention_queue), std::ref(errorstack));
     std::thread mail_thread;
@@ -530,20 +740,8 @@ void daemon(const research_config & cfg, const rule_cfg & rules, std::ostream &
 
     FILE_LOG(libs::log_level::DEBUG) << "threads started";
 
-    sigset_t set;
-    sigemptyset(&set);
-    sigaddset(&set, SIGINT);
-    sigaddset(&set, SIGTERM);
-    sigprocmask(SIG_SETMASK, &set, nullptr);
-    sigset_t signal_set;
-    const struct timespec timeout
-    {
-        1, 0
-    };  // 1s
-    siginfo_t info;
-    sigemptyset(&signal_set);
-    sigaddset(&signal_set, SIGINT);
-    sigaddset(&signal_set, SIGTERM);
+    std::future<void> reload_result;
+
     FILE_LOG(libs::log_level::INFO) << "research started";
 
     {
@@ -593,6 +791,20 @@ void daemon(const research_config & cfg, const rule_cfg & rules, std::ostream &
             throw libs::errno_exception{ "Error during sigtimedwait()" };
         }
 
+        if (info.si_signo == SIGHUP) {
+            if (reload_result.valid() && reload_result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                FILE_LOG(libs::log_level::WARNING) << "Rule reload already in progress; ignoring SIGHUP";
+            } else {
+                reload_result = std::async(std::launch::async, reload_rules, std::cref(cfg), std::ref(rules));
+            }
+            continue;
+        }
+
+        if (info.si_signo == SIGUSR1) {
+            log_stats(input_queue, shedder, dispatched);
+            continue;
+        }
+
         /* requested signal occurred */
         FILE_LOG(libs::log_level::DEBUG) << "Registered signal found";
         break;
@@ -613,6 +825,9 @@ void daemon(const research_config & cfg, const rule_cfg & rules, std::ostream &
     // TODO(cgzones): fix shutdown time in unit tests
 
     FILE_LOG(libs::log_level::DEBUG) << "waiting for threads...";
+    if (reload_result.valid()) {
+        reload_result.wait();
+    }
     input_thread.join();
     processing_thread.join();
     state_thread.join();
@@ -622,6 +837,30 @@ void daemon(const research_config & cfg, const rule_cfg & rules, std::ostream &
         mail_thread.join();
     }
     FILE_LOG(libs::log_level::DEBUG) << "threads finished";
+
+    report_slow_rules(cfg, guard);
+
+    if (shedder.total_shed() != 0) {
+        FILE_LOG(libs::log_level::INFO) << "Shed " << shedder.total_shed() << " events under load";
+    }
+    if (const auto stats = dispatched.get_stats(); stats.suppressed != 0) {
+        FILE_LOG(libs::log_level::INFO) << "Suppressed " << stats.suppressed << " repeated interventions (" << stats.dispatched << " dispatched)";
+    }
+
+    for (const auto & iter : rules_state) {
+        if (iter.second.approx.cap_hits() != 0) {
+            FILE_LOG(libs::log_level::INFO) << "Approximate activation group of rule " << iter.first << " hit its memory cap " << iter.second.approx.cap_hits()
+                                            << " times (" << iter.second.approx.memory_usage() / 1024 << " KiB in use)";
+        }
+        if (iter.second.distinct.cap_hits() != 0) {
+            FILE_LOG(libs::log_level::INFO) << "Distinct activation group of rule " << iter.first << " evicted " << iter.second.distinct.cap_hits()
+                                            << " keys due to its memory cap (" << iter.second.distinct.memory_usage() / 1024 << " KiB in use)";
+        }
+    }
+
+    if (!cfg.state_file.empty()) {
+        save_state(cfg, rules_state, snapshot);
+    }
 }
 
 } /* namespace ctguard::research */
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <memory>
+
 #include "config.hpp"
 #include "rule.hpp"
 
 namespace ctguard::research {
 
-void daemon(const research_config & cfg, const rule_cfg & rules, std::ostream & output);
+void daemon(const research_config & cfg, std::shared_ptr<const rule_cfg> rules, std::ostream & output);
 
 } /* namespace ctguard::research */
@@ -0,0 +1,201 @@
+#include "distinct_window.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../libs/hash.hpp"
+
+namespace ctguard::research {
+
+// rough per entry overhead of the node based containers
+static constexpr std::size_t NODE_OVERHEAD{ 64 };
+
+void distinct_counter::add(std::uint64_t hash)
+{
+    if (!exact()) {
+        add_register(hash);
+        return;
+    }
+
+    const auto iter = std::lower_bound(m_exact.begin(), m_exact.end(), hash);
+    if (iter != m_exact.end() && *iter == hash) {
+        return;
+    }
+    m_exact.insert(iter, hash);
+
+    if (m_exact.size() > EXACT_LIMIT) {
+        upgrade();
+    }
+}
+
+void distinct_counter::merge(const distinct_counter & other)
+{
+    if (other.exact()) {
+        for (const std::uint64_t hash : other.m_exact) {
+            add(hash);
+        }
+        return;
+    }
+
+    if (exact()) {
+        upgrade();
+    }
+    for (std::size_t i = 0; i < m_registers.size(); ++i) {
+        m_registers[i] = std::max(m_registers[i], other.m_registers[i]);
+    }
+}
+
+std::uint64_t distinct_counter::count() const
+{
+    if (exact()) {
+        return m_exact.size();
+    }
+
+    const auto m = static_cast<double>(m_registers.size());
+    double sum{ 0.0 };
+    unsigned zeros{ 0 };
+    for (const std::uint8_t reg : m_registers) {
+        sum += std::ldexp(1.0, -reg);
+        if (reg == 0) {
+            zeros++;
+        }
+    }
+
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    // small range correction: linear counting
+    if (estimate <= 2.5 * m && zeros != 0) {
+        estimate = m * std::log(m / zeros);
+    }
+
+    return static_cast<std::uint64_t>(std::llround(estimate));
+}
+
+void distinct_counter::upgrade()
+{
+    m_registers.assign(std::size_t{ 1 } << PRECISION, 0);
+    for (const std::uint64_t hash : m_exact) {
+        add_register(hash);
+    }
+    m_exact.clear();
+    m_exact.shrink_to_fit();
+}
+
+void distinct_counter::add_register(std::uint64_t hash) noexcept
+{
+    const std::uint64_t index = hash >> (64U - PRECISION);
+    // the guard bit bounds the rank if all remaining bits are zero
+    const std::uint64_t rest = (hash << PRECISION) | (std::uint64_t{ 1 } << (PRECISION - 1));
+    const auto rank = static_cast<std::uint8_t>(__builtin_clzll(rest) + 1);
+    m_registers[index] = std::max(m_registers[index], rank);
+}
+
+static std::size_t entry_bytes(const std::string & key, const std::vector<std::pair<std::time_t, distinct_counter>> & buckets) noexcept
+{
+    // the key is stored in the map and in the lru set
+    std::size_t bytes = 2 * (key.size() + NODE_OVERHEAD);
+    for (const auto & elem : buckets) {
+        bytes += sizeof(elem) + elem.second.memory_usage();
+    }
+    return bytes;
+}
+
+void distinct_window::configure(unsigned window_time, std::size_t memory_cap)
+{
+    if (window_time == m_window_time && memory_cap == m_memory_cap) {
+        return;
+    }
+
+    *this = distinct_window{};
+    m_window_time = window_time;
+    m_memory_cap = memory_cap;
+    // BUCKETS - 1 buckets cover the window, the remaining one is the currently filling bucket
+    m_bucket_time = std::max<std::time_t>(1, static_cast<std::time_t>((window_time + BUCKETS - 2) / (BUCKETS - 1)));
+}
+
+bool distinct_window::in_window(std::time_t bucket_start, std::time_t now) const noexcept
+{
+    return bucket_start + m_bucket_time + m_window_time > now;
+}
+
+void distinct_window::erase(std::map<std::string, key_entry>::iterator iter)
+{
+    m_bytes -= entry_bytes(iter->first, iter->second.buckets);
+    m_lru.erase({ iter->second.last_seen, iter->first });
+    m_keys.erase(iter);
+}
+
+bool distinct_window::add(const std::string & key, const std::string & value, std::time_t now)
+{
+    const std::time_t bucket_start = now / m_bucket_time * m_bucket_time;
+
+    // drop keys not seen within the window
+    while (!m_lru.empty() && !in_window(m_lru.begin()->first / m_bucket_time * m_bucket_time, now)) {
+        erase(m_keys.find(m_lru.begin()->second));
+    }
+
+    auto [iter, inserted] = m_keys.try_emplace(key);
+    auto & entry = iter->second;
+    if (!inserted) {
+        m_bytes -= entry_bytes(key, entry.buckets);
+        m_lru.erase({ entry.last_seen, key });
+    }
+    entry.last_seen = now;
+    m_lru.emplace(now, key);
+
+    auto & buckets = entry.buckets;
+    buckets.erase(buckets.begin(),
+                  std::find_if(buckets.begin(), buckets.end(), [this, now](const auto & elem) { return in_window(elem.first, now); }));
+    if (buckets.empty() || buckets.back().first != bucket_start) {
+        buckets.emplace_back(bucket_start, distinct_counter{});
+    }
+    buckets.back().second.add(libs::mix64(libs::fnv1a(value)));
+    m_bytes += entry_bytes(key, buckets);
+
+    bool evicted{ false };
+    while (m_bytes > m_memory_cap && m_lru.size() > 1) {
+        // the current key is the most recently seen one, so never evicted here
+        erase(m_keys.find(m_lru.begin()->second));
+        m_cap_hits++;
+        evicted = true;
+    }
+
+    if (evicted) {
+        const bool newly_capped = !m_capped;
+        m_capped = true;
+        return newly_capped;
+    }
+
+    // re-arm the cap warning once a quarter of the memory is free again
+    if (m_capped && m_bytes < m_memory_cap / 4 * 3) {
+        m_capped = false;
+    }
+
+    return false;
+}
+
+std::uint64_t distinct_window::count(const std::string & key, std::time_t now) const
+{
+    const auto iter = m_keys.find(key);
+    if (iter == m_keys.end()) {
+        return 0;
+    }
+
+    distinct_counter merged;
+    for (const auto & elem : iter->second.buckets) {
+        if (in_window(elem.first, now)) {
+            merged.merge(elem.second);
+        }
+    }
+    return merged.count();
+}
+
+void distinct_window::reset(const std::string & key)
+{
+    const auto iter = m_keys.find(key);
+    if (iter != m_keys.end()) {
+        erase(iter);
+    }
+}
+
+} /* namespace ctguard::research */
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ctguard::research {
+
+// Counts distinct values by their 64 bit hashes.
+// Small sets are kept exactly; beyond EXACT_LIMIT values the counter upgrades to a HyperLogLog
+// with 2^PRECISION registers (standard error about 3%).
+class distinct_counter
+{
+  public:
+    static constexpr std::size_t EXACT_LIMIT{ 128 };
+    static constexpr unsigned PRECISION{ 10 };
+
+    void add(std::uint64_t hash);
+    void merge(const distinct_counter & other);
+
+    [[nodiscard]] std::uint64_t count() const;
+    [[nodiscard]] bool exact() const noexcept { return m_registers.empty(); }
+    [[nodiscard]] std::size_t memory_usage() const noexcept { return m_exact.size() * sizeof(std::uint64_t) + m_registers.size(); }
+
+    template<class Archive>
+    void serialize(Archive & archive)
+    {
+        archive(m_exact, m_registers);
+    }
+
+  private:
+    std::vector<std::uint64_t> m_exact;  // sorted
+    std::vector<std::uint8_t> m_registers;
+
+    void upgrade();
+    void add_register(std::uint64_t hash) noexcept;
+};
+
+// Distinct values of a field per key within the time window of an activation group.
+// Every key holds one distinct_counter per time bucket; the window count merges them.
+// If the memory cap is exceeded, the least recently seen keys are evicted.
+class distinct_window
+{
+  public:
+    static constexpr std::size_t BUCKETS{ 8 };
+
+    // (Re-)initialize, dropping all data, if the window geometry changed.
+    void configure(unsigned window_time, std::size_t memory_cap);
+
+    // Count value for key; returns true if keys had to be evicted and were not before.
+    [[nodiscard]] bool add(const std::string & key, const std::string & value, std::time_t now);
+
+    // Estimated number of distinct values of key within the window.
+    [[nodiscard]] std::uint64_t count(const std::string & key, std::time_t now) const;
+
+    // Forget all values of key.
+    void reset(const std::string & key);
+
+    [[nodiscard]] bool empty() const noexcept { return m_keys.empty(); }
+    [[nodiscard]] std::size_t memory_usage() const noexcept { return m_bytes; }
+    [[nodiscard]] std::uint64_t cap_hits() const noexcept { return m_cap_hits; }
+
+    template<class Archive>
+    void serialize(Archive & archive)
+    {
+        archive(m_window_time, m_memory_cap, m_bucket_time, m_keys, m_lru, m_bytes, m_cap_hits, m_capped);
+    }
+
+  private:
+    struct key_entry
+    {
+        std::time_t last_seen{ 0 };
+        std::vector<std::pair<std::time_t, distinct_counter>> buckets;  // by bucket start
+
+        template<class Archive>
+        void serialize(Archive & archive)
+        {
+            archive(last_seen, buckets);
+        }
+    };
+
+    unsigned m_window_time{ 0 };
+    std::size_t m_memory_cap{ 0 };
+    std::time_t m_bucket_time{ 0 };
+    std::map<std::string, key_entry> m_keys;
+    std::set<std::pair<std::time_t, std::string>> m_lru;
+    std::size_t m_bytes{ 0 };
+    std::uint64_t m_cap_hits{ 0 };
+    bool m_capped{ false };
+
+    [[nodiscard]] bool in_window(std::time_t bucket_start, std::time_t now) const noexcept;
+    void erase(std::map<std::string, key_entry>::iterator iter);
+};
+
+} /* namespace ctguard::research */
@@ -8,11 +8,14 @@
 
 namespace ctguard::research {
 
-event::event(const libs::source_event & se) : m_logstr{ se.message }, m_control_message{ se.control_message }
+event::event(const libs::source_event & se) : m_logstr{ se.message }, m_control_message{ se.control_message }, m_repeats{ se.repeats }
 {
     m_traits.insert({ "hostname", se.hostname });
     m_traits.insert({ "source_program", se.source_program });
     m_traits.insert({ "source_domain", se.source_domain });
+    if (se.repeats > 0) {
+        m_traits.insert({ "repeats", std::to_string(se.repeats) });
+    }
     m_traits.insert({ "control", [&]() {
                          if (m_control_message) {
                              return "true";
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <set>
@@ -18,6 +19,12 @@ struct intervention_rule
     std::string name;
     std::string field;
     bool ignore_empty_field{ false };
+
+    template<class Archive>
+    void serialize(Archive & archive)
+    {
+        archive(name, field, ignore_empty_field);
+    }
 };
 
 class event
@@ -46,9 +53,17 @@ class event
     void description(std::string description) { m_description = std::move(description); }
     void interventions(std::vector<struct intervention_rule> interventions) { m_intervention_rules = std::move(interventions); }
     const std::vector<intervention_rule> & interventions() const { return m_intervention_rules; }
+    // Number of log lines this event stands for, more than one if the sender folded repeats.
+    std::uint64_t hits() const { return std::uint64_t{ m_repeats } + 1; }
 
     event update(const rule & rule) const;
 
+    template<class Archive>
+    void serialize(Archive & archive)
+    {
+        archive(m_logstr, m_description, m_control_message, m_always_alert, m_fields, m_traits, m_groups, m_priority, m_rule_id, m_intervention_rules, m_repeats);
+    }
+
   private:
     std::string m_logstr, m_description;
     bool m_control_message{ false };
@@ -59,6 +74,7 @@ class event
     priority_t m_priority{ 0 };
     rule_id_t m_rule_id{ 0 };
     std::vector<struct intervention_rule> m_intervention_rules;
+    unsigned m_repeats{ 0 };
 
     friend event make_unless_event();
 };
@@ -0,0 +1,69 @@
+#include "intervention_cache.hpp"
+
+#include "../libs/logger.hpp"
+
+namespace ctguard::research {
+
+bool intervention_cache::check(const std::string & name, const std::string & argument, std::time_t now)
+{
+    std::lock_guard lg{ m_mutex };
+
+    if (m_ttl == 0) {
+        m_stats.dispatched++;
+        return true;
+    }
+
+    auto iter = m_entries.find(key_t{ name, argument });
+    if (iter != m_entries.end() && iter->second.expires > now) {
+        iter->second.repeats++;
+        m_stats.suppressed++;
+        return false;
+    }
+    if (iter != m_entries.end()) {
+        erase(iter);
+    }
+
+    if (m_entries.size() >= m_max_entries && !m_expiry.empty()) {
+        erase(m_entries.find(m_expiry.begin()->second));
+        m_stats.evicted++;
+    }
+
+    const std::time_t expires{ now + m_ttl };
+    key_t k{ name, argument };
+    m_expiry.emplace(expires, k);
+    m_entries.emplace(std::move(k), entry{ expires, 0 });
+    m_stats.dispatched++;
+
+    return true;
+}
+
+void intervention_cache::expire(std::time_t now)
+{
+    std::lock_guard lg{ m_mutex };
+
+    while (!m_expiry.empty() && m_expiry.begin()->first <= now) {
+        erase(m_entries.find(m_expiry.begin()->second));
+    }
+}
+
+intervention_cache::stats intervention_cache::get_stats() const
+{
+    std::lock_guard lg{ m_mutex };
+
+    stats result{ m_stats };
+    result.entries = m_entries.size();
+    return result;
+}
+
+void intervention_cache::erase(std::map<key_t, entry>::iterator iter)
+{
+    if (iter->second.repeats > 0) {
+        FILE_LOG(libs::log_level::DEBUG) << "Suppressed " << iter->second.repeats << " repeats of intervention '" << iter->first.first << "' with argument '"
+                                         << iter->first.second << "'";
+    }
+
+    m_expiry.erase(std::make_pair(iter->second.expires, iter->first));
+    m_entries.erase(iter);
+}
+
+} /* namespace ctguard::research */
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+
+namespace ctguard::research {
+
+// Remembers the interventions dispatched within the last ttl seconds by name and argument,
+// so repeats, e.g. by many alerts of one attacker, are suppressed instead of executed again.
+// The number of entries is bounded; if full, the entry expiring next is dropped early.
+class intervention_cache
+{
+  public:
+    struct stats
+    {
+        std::size_t entries{ 0 };
+        std::uint64_t dispatched{ 0 };
+        std::uint64_t suppressed{ 0 };
+        std::uint64_t evicted{ 0 };
+    };
+
+    // A ttl of 0 disables the cache.
+    intervention_cache(unsigned ttl, std::size_t max_entries) : m_ttl{ ttl }, m_max_entries{ max_entries } {}
+
+    // Returns false if the intervention was dispatched within the ttl and should be suppressed.
+    [[nodiscard]] bool check(const std::string & name, const std::string & argument, std::time_t now);
+
+    // Drop all entries expired at now.
+    void expire(std::time_t now);
+
+    [[nodiscard]] stats get_stats() const;
+
+  private:
+    using key_t = std::pair<std::string, std::string>;
+    struct entry
+    {
+        std::time_t expires;
+        std::uint64_t repeats;
+    };
+
+    const std::time_t m_ttl;
+    const std::size_t m_max_entries;
+
+    mutable std::mutex m_mutex;
+    std::map<key_t, entry> m_entries;
+    std::set<std::pair<std::time_t, key_t>> m_expiry;
+    stats m_stats;
+
+    void erase(std::map<key_t, entry>::iterator iter);
+};
+
+} /* namespace ctguard::research */
@@ -0,0 +1,84 @@
+#include "load_shedder.hpp"
+
+#include <unistd.h>  // ::gethostname
+
+#include <array>
+#include <sstream>
+
+namespace ctguard::research {
+
+bool load_shedder::admit(const libs::source_event & se, std::size_t queue_size)
+{
+    if (m_high_water == 0 || se.control_message) {
+        return true;
+    }
+
+    if (!m_shedding) {
+        if (queue_size < m_high_water) {
+            return true;
+        }
+        m_shedding = true;
+    }
+
+    bool keep;
+    if (queue_size >= 2 * m_high_water || m_shed_domains.find(se.source_domain) != m_shed_domains.end()) {
+        keep = false;
+    } else {
+        keep = m_sample_counter[se.source_domain]++ % m_sample_rate == 0;
+    }
+
+    if (!keep) {
+        m_shed[se.source_domain]++;
+        m_total.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return keep;
+}
+
+std::optional<libs::source_event> load_shedder::report(std::size_t queue_size, std::time_t now)
+{
+    // stop once the queue drained to half the high water mark
+    if (m_shedding && queue_size < m_high_water / 2) {
+        m_shedding = false;
+        m_sample_counter.clear();
+    }
+
+    if (m_shed.empty()) {
+        return std::nullopt;
+    }
+
+    if (m_last_report == 0) {
+        m_last_report = now;
+    }
+    if (m_shedding && now < m_last_report + REPORT_INTERVAL) {
+        return std::nullopt;
+    }
+
+    std::uint64_t sum{ 0 };
+    std::ostringstream domains;
+    for (const auto & elem : m_shed) {
+        sum += elem.second;
+        if (domains.tellp() != 0) {
+            domains << ", ";
+        }
+        domains << elem.first << ": " << elem.second;
+    }
+
+    std::array<char, 512> buffer{};
+    ::gethostname(buffer.data(), buffer.size() - 1);
+
+    libs::source_event se;
+    se.control_message = true;
+    se.message = "Load shedding: dropped " + std::to_string(sum) + " events (" + domains.str() + ")" + (m_shedding ? "; still shedding" : "");
+    se.source_program = "ctguard-research";
+    se.time_scanned = se.time_send = now;
+    se.hostname = buffer.data();
+    se.source_domain = "daemon";
+
+    m_shed.clear();
+    m_last_report = m_shedding ? now : 0;
+
+    return se;
+}
+
+} /* namespace ctguard::research */
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+
+#include "../libs/source_event.hpp"
+
+namespace ctguard::research {
+
+// Decides which received events are queued for processing while research falls behind.
+// Once the queue holds high_water events, events of the shed domains are dropped and only
+// every sample_rate-th event per source domain is kept; at twice the high water mark all
+// events are dropped. Control messages are never dropped.
+class load_shedder
+{
+  public:
+    static constexpr std::time_t REPORT_INTERVAL{ 60 };
+
+    // A high_water of 0 disables shedding.
+    load_shedder(std::size_t high_water, unsigned sample_rate, std::set<std::string> shed_domains)
+      : m_high_water{ high_water }, m_sample_rate{ sample_rate }, m_shed_domains{ std::move(shed_domains) }
+    {}
+
+    // Whether se should be queued, given the current queue size.
+    [[nodiscard]] bool admit(const libs::source_event & se, std::size_t queue_size);
+
+    // Control message summarizing the shed events, once shedding stopped or every REPORT_INTERVAL while shedding.
+    [[nodiscard]] std::optional<libs::source_event> report(std::size_t queue_size, std::time_t now);
+
+    [[nodiscard]] bool shedding() const noexcept { return m_shedding; }
+    // Safe to call from other threads, e.g. for statistics.
+    [[nodiscard]] std::uint64_t total_shed() const noexcept { return m_total.load(std::memory_order_relaxed); }
+
+  private:
+    const std::size_t m_high_water;
+    const unsigned m_sample_rate;
+    const std::set<std::string> m_shed_domains;
+
+    bool m_shedding{ false };
+    std::time_t m_last_report{ 0 };
+    std::map<std::string, std::uint64_t> m_sample_counter;
+    std::map<std::string, std::uint64_t> m_shed;  // per source domain since the last report
+    std::atomic<std::uint64_t> m_total{ 0 };
+};
+
+} /* namespace ctguard::research */
@@ -1,13 +1,105 @@
 #include "process_log.hpp"
 
 #include "../libs/libexception.hpp"
+#include "../libs/log_format.hpp"
+#include "../libs/logger.hpp"
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <regex>
 
 namespace ctguard::research {
 
+static bool check_distinct_activation(const event & ev, const rule & rl, bool found_activation_group, struct rule_state & rs,
+                                      std::vector<std::pair<std::string, std::string>> & modified_traits, bool verbose)
+{
+    const auto & ag = rl.activation_group();
+    std::string key;
+    if (!rl.same_field().empty()) {
+        const auto & actual_field = ev.fields().find(rl.same_field());
+        if (actual_field == ev.fields().end()) {
+            if (verbose) {
+                std::cout << "inactive_d(no field)|";
+            }
+            return false;
+        }
+        key = actual_field->second;
+    }
+
+    const auto current_time = std::time(nullptr);
+    std::lock_guard<std::mutex> lg{ rs.mutex };
+    rs.distinct.configure(ag.time, std::size_t{ ag.max_memory } * 1024);
+
+    const auto & distinct_field = ev.fields().find(rl.distinct_field());
+    if (found_activation_group && distinct_field != ev.fields().end()) {
+        rs.dirty = true;
+        if (rs.distinct.add(key, distinct_field->second, current_time)) {
+            FILE_LOG(libs::log_level::WARNING) << "Memory cap of " << ag.max_memory << " KiB reached for distinct activation group of rule " << rl.id()
+                                               << ", evicting least recently seen keys (evictions: " << rs.distinct.cap_hits() << ")";
+        }
+    }
+
+    const std::uint64_t distinct_rate = rs.distinct.count(key, current_time);
+    if (distinct_rate < ag.rate) {
+        if (verbose) {
+            std::cout << "inactive_d(" << distinct_rate << "/" << ag.rate << ")|";
+        }
+        return false;
+    }
+
+    modified_traits.emplace_back("trigger_distinct_count", std::to_string(distinct_rate));
+    if (verbose) {
+        std::cout << "active_d(" << distinct_rate << "/" << ag.rate << ")|";
+    }
+    return true;
+}
+
+static bool check_approximate_activation(const event & ev, const rule & rl, bool found_activation_group, struct rule_state & rs,
+                                         std::vector<std::pair<std::string, std::string>> & modified_traits, bool verbose)
+{
+    const auto & ag = rl.activation_group();
+    const auto & actual_field = ev.fields().find(rl.same_field());
+    if (actual_field == ev.fields().end()) {
+        if (verbose) {
+            std::cout << "inactive_a(no field)|";
+        }
+        return false;
+    }
+
+    const auto current_time = std::time(nullptr);
+    std::lock_guard<std::mutex> lg{ rs.mutex };
+    rs.approx.configure(ag.time, std::size_t{ ag.max_memory } * 1024);
+
+    if (found_activation_group) {
+        rs.dirty = true;
+        if (rs.approx.add(actual_field->second, ev.logstr(), current_time, ag.escalate, ev.hits())) {
+            FILE_LOG(libs::log_level::WARNING) << "Memory cap of " << ag.max_memory << " KiB reached for approximate activation group of rule " << rl.id()
+                                               << ", further keys are only estimated (cap hits: " << rs.approx.cap_hits() << ")";
+        }
+    }
+
+    const std::uint64_t same_rate = rs.approx.count(actual_field->second, current_time);
+    if (same_rate < ag.rate) {
+        if (verbose) {
+            std::cout << "inactive_a(" << same_rate << "/" << ag.rate << ")|";
+        }
+        return false;
+    }
+
+    std::ostringstream otriggers;
+    for (const auto & logstr : rs.approx.logs(actual_field->second, current_time)) {
+        otriggers << logstr << '\n';
+    }
+    modified_traits.emplace_back("trigger_same_logs", otriggers.str());
+    modified_traits.emplace_back("trigger_count", std::to_string(same_rate));
+    if (verbose) {
+        std::cout << "active_a(" << same_rate << "/" << ag.rate << ")|";
+    }
+    return true;
+}
+
 static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::vector<std::pair<std::string, std::string>>> check_rule(
-  const event & ev, const rule & rl, std::map<rule_id_t, struct rule_state> & rules_state, bool verbose)
+  const event & ev, const rule & rl, std::map<rule_id_t, struct rule_state> & rules_state, regex_guard & guard, bool verbose)
 {
     bool match_something{ false };
     bool is_active{ false };
@@ -29,8 +121,10 @@ static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::v
             rules_state[rl.id()].unless_triggered = std::time(nullptr);
             rules_state[rl.id()].unless_timeout = rl.unless_rule().timeout;
             rules_state[rl.id()].unless_event = ev.update(rl);
+            rules_state[rl.id()].dirty = true;
         } else if (ev.rule_id() == rl.unless_rule().id) {
             rules_state[rl.id()].unless_triggered = 0;
+            rules_state[rl.id()].dirty = true;
         } else {
             std::ostringstream oss;
             for (const auto & i : rl.parent_ids()) {
@@ -56,13 +150,18 @@ static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::v
         }
 
         const auto & iter = rules_state.find(rl.id());
-        if (iter == rules_state.end()) {
+        if (!rl.distinct_field().empty()) {
+            is_active = check_distinct_activation(ev, rl, found_activation_group, rules_state[rl.id()], modified_traits, verbose);
+        } else if (rl.activation_group().approximate) {
+            is_active = check_approximate_activation(ev, rl, found_activation_group, rules_state[rl.id()], modified_traits, verbose);
+        } else if (iter == rules_state.end()) {
             if (verbose) {
                 std::cout << "init rstate|";
             }
 
             if (found_activation_group) {
                 rules_state[rl.id()].mevents.emplace(std::time(nullptr), ev);
+                rules_state[rl.id()].dirty = true;
             }
 
         } else {
@@ -70,6 +169,7 @@ static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::v
             auto & saved_events{ iter->second.mevents };
             if (found_activation_group) {
                 saved_events.emplace(std::time(nullptr), ev);
+                iter->second.dirty = true;
             }
 
             // delete too old entries
@@ -79,6 +179,7 @@ static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::v
                     const auto & i = saved_events.begin();
                     if (i->first + rl.activation_group().time < current_time) {
                         saved_events.erase(i);
+                        iter->second.dirty = true;
                     } else {
                         // break, cause elements are sorted by time
                         break;
@@ -86,7 +187,13 @@ static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::v
                 }
             }
 
-            if (saved_events.size() >= rl.activation_group().rate) {
+            // events folded by the sender count for all the lines they stand for
+            std::uint64_t rate{ 0 };
+            for (const auto & evs : saved_events) {
+                rate += evs.second.hits();
+            }
+
+            if (rate >= rl.activation_group().rate) {
                 if (rl.same_field().empty()) {
                     is_active = true;
                     std::ostringstream otriggers;
@@ -96,18 +203,18 @@ static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::v
                     modified_traits.emplace_back("trigger_logs", otriggers.str());
 
                     if (verbose) {
-                        std::cout << "active(" << saved_events.size() << "/" << rl.activation_group().rate << ")|";
+                        std::cout << "active(" << rate << "/" << rl.activation_group().rate << ")|";
                     }
                 } else {
                     // count same fields
                     const auto & actual_field = ev.fields().find(rl.same_field());
                     if (actual_field != ev.fields().end()) {
-                        rule_activation_rate_t same_rate{ 0 };
+                        std::uint64_t same_rate{ 0 };
                         std::ostringstream otriggers;
                         for (const auto & i : saved_events) {
                             const auto & stored_field = i.second.fields().find(rl.same_field());
                             if (stored_field != i.second.fields().end() && actual_field->second == stored_field->second) {
-                                same_rate++;
+                                same_rate += i.second.hits();
                                 otriggers << i.second.logstr() << '\n';
                             }
                         }
@@ -125,7 +232,7 @@ static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::v
                     }
                 }
             } else if (verbose) {
-                std::cout << "inactive(" << iter->second.mevents.size() << "/" << rl.activation_group().rate << ")|";
+                std::cout << "inactive(" << rate << "/" << rl.activation_group().rate << ")|";
             }
         }
     } else {
@@ -170,9 +277,9 @@ static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::v
             for (const auto & field : ev.fields()) {
                 if (field.first == iter.first) {
                     found = true;
-                    switch (iter.second.first) {
+                    switch (iter.second.match) {
                         case rule_match::exact:
-                            if (field.second != iter.second.second) {
+                            if (field.second != iter.second.value) {
                                 if (verbose) {
                                     std::cout << "field '" << iter.first << "' exact mismatch\n";
                                 }
@@ -187,20 +294,36 @@ static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::v
                                 return { false, modified_fields, modified_traits };
                             }
                             break;
-                        case rule_match::regex:
+                        case rule_match::regex: {
                             std::smatch match;
-                            const std::regex regex{ iter.second.second };
-                            if (!std::regex_search(field.second, match, regex)) {
+                            if (!guard.search(field.second, match, *iter.second.reg, rl.id())) {
                                 if (verbose) {
                                     std::cout << "field '" << iter.first << "' regex mismatch\n";
                                 }
                                 return { false, modified_fields, modified_traits };
                             }
                             break;
+                        }
+                        case rule_match::cidr:
+                            if (!iter.second.cidr.contains(field.second)) {
+                                if (verbose) {
+                                    std::cout << "field '" << iter.first << "' cidr mismatch\n";
+                                }
+                                return { false, modified_fields, modified_traits };
+                            }
+                            break;
+                        case rule_match::list:
+                            if (iter.second.list.find(field.second) == iter.second.list.end()) {
+                                if (verbose) {
+                                    std::cout << "field '" << iter.first << "' list mismatch\n";
+                                }
+                                return { false, modified_fields, modified_traits };
+                            }
+                            break;
                     }
                 }
             }
-            if (!found && iter.second.first != rule_match::empty) {
+            if (!found && iter.second.match != rule_match::empty) {
                 if (verbose) {
                     std::cout << "field '" << iter.first << "' not found\n";
                 }
@@ -219,9 +342,9 @@ static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::v
             for (const auto & field : ev.traits()) {
                 if (field.first == iter.first) {
                     found = true;
-                    switch (iter.second.first) {
+                    switch (iter.second.match) {
                         case rule_match::exact:
-                            if (field.second != iter.second.second) {
+                            if (field.second != iter.second.value) {
                                 if (verbose) {
                                     std::cout << "trait '" << iter.first << "' exact mismatch\n";
                                 }
@@ -236,20 +359,36 @@ static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::v
                                 return { false, modified_fields, modified_traits };
                             }
                             break;
-                        case rule_match::regex:
+                        case rule_match::regex: {
                             std::smatch match;
-                            const std::regex regex{ iter.second.second };
-                            if (!std::regex_search(field.second, match, regex)) {
+                            if (!guard.search(field.second, match, *iter.second.reg, rl.id())) {
                                 if (verbose) {
                                     std::cout << "trait '" << iter.first << "' regex mismatch\n";
                                 }
                                 return { false, modified_fields, modified_traits };
                             }
                             break;
+                        }
+                        case rule_match::cidr:
+                            if (!iter.second.cidr.contains(field.second)) {
+                                if (verbose) {
+                                    std::cout << "trait '" << iter.first << "' cidr mismatch\n";
+                                }
+                                return { false, modified_fields, modified_traits };
+                            }
+                            break;
+                        case rule_match::list:
+                            if (iter.second.list.find(field.second) == iter.second.list.end()) {
+                                if (verbose) {
+                                    std::cout << "trait '" << iter.first << "' list mismatch\n";
+                                }
+                                return { false, modified_fields, modified_traits };
+                            }
+                            break;
                     }
                 }
             }
-            if (!found && iter.second.first != rule_match::empty) {
+            if (!found && iter.second.match != rule_match::empty) {
                 if (verbose) {
                     std::cout << "trait '" << iter.first << "' not found\n";
                 }
@@ -262,7 +401,7 @@ static std::tuple<bool, std::vector<std::pair<std::string, std::string>>, std::v
         match_something = true;
         std::smatch match;
         const std::string & to_match = ev.fields().find("log") != ev.fields().end() ? ev.fields().find("log")->second : ev.logstr();
-        if (!std::regex_search(to_match, match, *rl.reg())) {
+        if (!guard.search(to_match, match, *rl.reg(), rl.id())) {
             if (verbose) {
                 std::cout << "no regex match\n";
             }
@@ -329,11 +468,21 @@ static void update_state(std::map<rule_id_t, struct rule_state> & rules_state, c
         const auto & iter = rules_state.find(rl.id());
         if (iter != rules_state.end()) {
             std::lock_guard<std::mutex> lg{ iter->second.mutex };
-            if (rl.same_field().empty()) {
+            iter->second.dirty = true;
+            if (!rl.distinct_field().empty()) {
+                const auto & actual_field = ev.fields().find(rl.same_field());
+                if (rl.same_field().empty()) {
+                    iter->second.distinct.reset(std::string{});
+                } else if (actual_field != ev.fields().end()) {
+                    iter->second.distinct.reset(actual_field->second);
+                }
+            } else if (rl.same_field().empty()) {
                 iter->second.mevents.clear();
             } else {
                 const auto & actual_field = ev.fields().find(rl.same_field());
-                if (actual_field != ev.fields().end()) {
+                if (actual_field != ev.fields().end() && rl.activation_group().approximate) {
+                    iter->second.approx.reset(actual_field->second, std::time(nullptr));
+                } else if (actual_field != ev.fields().end()) {
                     erase_if(iter->second.mevents, [&rl, &actual_field](const auto & elem) {
                         const auto & stored_field = elem.second.fields().find(rl.same_field());
                         return stored_field != elem.second.fields().end() && actual_field->second == stored_field->second;
@@ -344,7 +493,8 @@ static void update_state(std::map<rule_id_t, struct rule_state> & rules_state, c
     }
 }
 
-static void check_top_rules(event & e, const std::vector<rule> & rules, unsigned depth, std::map<rule_id_t, struct rule_state> & rules_state, bool verbose)
+static void check_top_rules(event & e, const std::vector<rule> & rules, unsigned depth, std::map<rule_id_t, struct rule_state> & rules_state, regex_guard & guard,
+                            bool verbose)
 {
     std::vector<std::tuple<const rule *, std::vector<std::pair<std::string, std::string>>, std::vector<std::pair<std::string, std::string>>>>
       top_matching_rules;
@@ -360,7 +510,7 @@ static void check_top_rules(event & e, const std::vector<rule> & rules, unsigned
             std::cout << "    Checking level " << depth << " rule " << r.id() << " ...";
         }
 
-        auto result = check_rule(e, r, rules_state, verbose);
+        auto result = check_rule(e, r, rules_state, guard, verbose);
         if (std::get<0>(result)) {
             top_matching_rules.emplace_back(&r, std::move(std::get<1>(result)), std::move(std::get<2>(result)));
         }
@@ -402,15 +552,17 @@ static void check_top_rules(event & e, const std::vector<rule> & rules, unsigned
             std::cout << "    Checking child rules (#" << fit->children().size() << ") ...\n";
         }
 
-        check_top_rules(e, fit->children(), depth + 1, rules_state, verbose);
+        check_top_rules(e, fit->children(), depth + 1, rules_state, guard, verbose);
     }
 }
 
-static void format_log(event & e, const std::vector<format> & formats, bool verbose)
+static void format_log(event & e, const std::vector<format> & formats, regex_guard & guard, bool verbose)
 {
+    const std::string_view input{ libs::format_input(e.logstr()) };
+
     for (const auto & f : formats) {
-        std::smatch match;
-        if (!std::regex_match(e.logstr(), match, f.reg())) {
+        libs::format_match match;
+        if (!guard.match(input, match, f.reg(), f.name())) {
             if (verbose) {
                 std::cout << f.name() << " not matching|";
             }
@@ -437,7 +589,30 @@ static void format_log(event & e, const std::vector<format> & formats, bool verb
     e.traits()["format"] = "unknown";
 }
 
-event process_log(const libs::source_event & se, bool verbose, const rule_cfg & rules, std::map<rule_id_t, struct rule_state> & rules_state)
+// Use the format and fields already extracted by the sender, if it matched against a format research knows with the same fields.
+// Lines the sender could not format are matched again, its formats might be outdated.
+static bool use_extracted_format(event & e, const libs::source_event & se, const std::vector<format> & formats, bool verbose)
+{
+    const auto f = std::find_if(formats.begin(), formats.end(), [&se](const format & fmt) { return fmt.name() == se.format; });
+    if (f == formats.end() || se.fields.size() > f->fields().size() ||
+        std::any_of(f->fields().begin(), f->fields().end(), [&se](const std::string & name) { return se.fields.count(name) == 0; })) {
+        return false;
+    }
+
+    if (verbose) {
+        std::cout << se.format << " extracted by sender\n";
+    }
+
+    for (const auto & elem : se.fields) {
+        e.fields()[elem.first] = elem.second;
+    }
+    e.traits()["format"] = se.format;
+
+    return true;
+}
+
+event process_log(const libs::source_event & se, bool verbose, const rule_cfg & rules, std::map<rule_id_t, struct rule_state> & rules_state,
+                  regex_guard & guard)
 {
     if (verbose) {
         std::cout << "\n  Processing '" << se.message << "' ...\n";
@@ -447,7 +622,10 @@ event process_log(const libs::source_event & se, bool verbose, const rule_cfg &
     if (verbose) {
         std::cout << "    Format (#" << rules.formats.size() << ") ...  ";
     }
-    format_log(e, rules.formats, verbose);
+    guard.start_event();
+    if (!use_extracted_format(e, se, rules.formats, verbose)) {
+        format_log(e, rules.formats, guard, verbose);
+    }
 
     if (verbose) {
         std::cout << "      Traits:\n";
@@ -464,7 +642,7 @@ event process_log(const libs::source_event & se, bool verbose, const rule_cfg &
         std::cout << "      Priority: " << e.priority() << "\n";
     }
 
-    check_top_rules(e, rules.std_rules, 1, rules_state, verbose);
+    check_top_rules(e, rules.std_rules, 1, rules_state, guard, verbose);
 
     if (verbose) {
         std::cout << "      Traits:\n";
@@ -483,7 +661,7 @@ event process_log(const libs::source_event & se, bool verbose, const rule_cfg &
         std::cout << "    Checking group rules...\n";
     }
 
-    check_top_rules(e, rules.group_rules, 1, rules_state, verbose);
+    check_top_rules(e, rules.group_rules, 1, rules_state, guard, verbose);
 
     if (verbose) {
         std::cout << "      Traits:\n";
@@ -502,6 +680,20 @@ event process_log(const libs::source_event & se, bool verbose, const rule_cfg &
         std::cout << "  End extracting.\n";
     }
 
+    if (guard.budget_exceeded()) {
+        e.traits()["regex_budget_exceeded"] = "true";
+
+        // Rules on this trait could not see the exhaustion during the passes above; let them raise the priority now.
+        std::vector<rule> budget_rules;
+        std::copy_if(rules.std_rules.cbegin(), rules.std_rules.cend(), std::back_inserter(budget_rules), [&e](const rule & r) {
+            return r.priority() >= e.priority() && r.trigger_traits().count("regex_budget_exceeded") != 0;
+        });
+        check_top_rules(e, budget_rules, 1, rules_state, guard, verbose);
+    }
+    if (guard.truncated()) {
+        e.traits()["regex_truncated"] = "true";
+    }
+
     return e;
 }
 
@@ -4,11 +4,13 @@
 #include <string>
 
 #include "event.hpp"
+#include "regex_guard.hpp"
 #include "research.hpp"
 #include "rule.hpp"
 
 namespace ctguard ::research {
 
-event process_log(const libs::source_event & se, bool verbose, const rule_cfg & rules, std::map<rule_id_t, struct rule_state> & rules_state);
+event process_log(const libs::source_event & se, bool verbose, const rule_cfg & rules, std::map<rule_id_t, struct rule_state> & rules_state,
+                  regex_guard & guard);
 
 } /* namespace ctguard::research */
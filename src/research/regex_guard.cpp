@@ -0,0 +1,77 @@
+#include "regex_guard.hpp"
+
+namespace ctguard::research {
+
+template<typename Eval>
+bool regex_guard::evaluate(Eval && eval, rule_id_t id, const std::string * name)
+{
+    if (m_used >= m_budget) {
+        if (!m_exceeded) {
+            m_exceeded = true;
+            std::lock_guard lg{ m_mutex };
+            m_exceeded_events++;
+        }
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    bool result{ false };
+    bool error{ false };
+    try {
+        result = eval();
+    } catch (const std::regex_error &) {
+        // e.g. error_complexity or error_stack
+        error = true;
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    m_used += elapsed;
+
+    if (error || elapsed >= m_slow_threshold) {
+        std::lock_guard lg{ m_mutex };
+        auto & entry = m_slow[name != nullptr ? "format " + *name : "rule " + std::to_string(id)];
+        if (error) {
+            entry.errors++;
+        } else {
+            entry.count++;
+            entry.max = std::max(entry.max, std::chrono::duration_cast<std::chrono::microseconds>(elapsed));
+        }
+    }
+
+    return result;
+}
+
+std::pair<std::size_t, std::regex_constants::match_flag_type> regex_guard::cut(std::size_t size)
+{
+    if (size <= m_max_length) {
+        return { size, std::regex_constants::match_default };
+    }
+
+    m_truncated = true;
+    // the cut end is not the end of the line
+    return { m_max_length, std::regex_constants::match_not_eol };
+}
+
+bool regex_guard::search(const std::string & input, std::smatch & match, const std::regex & re, rule_id_t id)
+{
+    const auto [length, flags] = cut(input.size());
+    const auto end = input.cbegin() + static_cast<std::ptrdiff_t>(length);
+    return evaluate([&, flags = flags]() { return std::regex_search(input.cbegin(), end, match, re, flags); }, id, nullptr);
+}
+
+bool regex_guard::match(std::string_view input, libs::format_match & match, const std::regex & re, const std::string & name)
+{
+    const auto [length, flags] = cut(input.size());
+    const auto end = input.cbegin() + static_cast<std::ptrdiff_t>(length);
+    return evaluate([&, flags = flags]() { return std::regex_match(input.cbegin(), end, match, re, flags); }, 0, &name);
+}
+
+std::pair<std::map<std::string, regex_guard::slow_entry>, unsigned long> regex_guard::take_report()  // NOLINT(google-runtime-int)
+{
+    std::lock_guard lg{ m_mutex };
+    std::pair<std::map<std::string, slow_entry>, unsigned long> result{ std::move(m_slow), m_exceeded_events };  // NOLINT(google-runtime-int)
+    m_slow.clear();
+    m_exceeded_events = 0;
+    return result;
+}
+
+} /* namespace ctguard::research */
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../libs/log_format.hpp"
+#include "event.hpp"
+
+namespace ctguard::research {
+
+// Bounds the cost of regex evaluation for hostile input and reports rules and formats evaluating slowly.
+// Input is cut to max_length bytes before evaluation, where the cut end does not match `$'. All evaluations of one event share a time budget;
+// once it is used up, further evaluations do not match. A running evaluation can not be interrupted,
+// so the budget bounds the number of evaluations started, each bounded by the length cap.
+class regex_guard
+{
+  public:
+    regex_guard(std::size_t max_length, std::chrono::milliseconds budget, std::chrono::milliseconds slow_threshold)
+      : m_max_length{ max_length }, m_budget{ budget }, m_slow_threshold{ slow_threshold }
+    {}
+
+    // Start a new event, resetting the budget.
+    void start_event() noexcept
+    {
+        m_used = std::chrono::steady_clock::duration::zero();
+        m_exceeded = false;
+        m_truncated = false;
+    }
+
+    // Whether the budget of the current event was used up.
+    [[nodiscard]] bool budget_exceeded() const noexcept { return m_exceeded; }
+
+    // Whether input of the current event was cut for evaluation.
+    [[nodiscard]] bool truncated() const noexcept { return m_truncated; }
+
+    // std::regex_search for rule id; false on budget exhaustion or regex errors.
+    [[nodiscard]] bool search(const std::string & input, std::smatch & match, const std::regex & re, rule_id_t id);
+
+    // std::regex_match for the format name; false on budget exhaustion or regex errors.
+    [[nodiscard]] bool match(std::string_view input, libs::format_match & match, const std::regex & re, const std::string & name);
+
+    struct slow_entry
+    {
+        unsigned long count{ 0 };   // NOLINT(google-runtime-int)
+        unsigned long errors{ 0 };  // NOLINT(google-runtime-int)
+        std::chrono::microseconds max{ 0 };
+    };
+
+    // Slow or failed evaluations per rule/format and the number of events exceeding the budget since the last call.
+    [[nodiscard]] std::pair<std::map<std::string, slow_entry>, unsigned long> take_report();  // NOLINT(google-runtime-int)
+
+  private:
+    const std::size_t m_max_length;
+    const std::chrono::steady_clock::duration m_budget;
+    const std::chrono::steady_clock::duration m_slow_threshold;
+
+    std::chrono::steady_clock::duration m_used{ 0 };
+    bool m_exceeded{ false };
+    bool m_truncated{ false };
+
+    std::mutex m_mutex;
+    std::map<std::string, slow_entry> m_slow;
+    unsigned long m_exceeded_events{ 0 };  // NOLINT(google-runtime-int)
+
+    // Length of input of size to evaluate and the flags for it.
+    [[nodiscard]] std::pair<std::size_t, std::regex_constants::match_flag_type> cut(std::size_t size);
+
+    template<typename Eval>
+    bool evaluate(Eval && eval, rule_id_t id, const std::string * name);
+};
+
+} /* namespace ctguard::research */
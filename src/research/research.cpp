@@ -15,6 +15,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
@@ -22,7 +23,6 @@
 #include "../libs/check_file_perms.hpp"
 #include "../libs/config/parser.hpp"
 #include "../libs/errnoexception.hpp"
-#include "../libs/filesystem/directory.hpp"
 #include "../libs/logger.hpp"
 #include "../libs/scopeguard.hpp"
 #include "../libs/source_event.hpp"
@@ -38,14 +38,15 @@ using ctguard::libs::FILELog;
 using ctguard::libs::log_level;
 using ctguard::libs::Output2FILE;
 using ctguard::libs::source_event;
-using ctguard::libs::filesystem::directory;
-using ctguard::libs::filesystem::file_object;
 using ctguard::research::event;
+using ctguard::research::load_rules;
 using ctguard::research::parse_config;
+using ctguard::research::regex_guard;
 using ctguard::research::research_config;
 using ctguard::research::rule_cfg;
 using ctguard::research::rule_id_t;
 using ctguard::research::rule_state;
+using ctguard::research::rules_load_stats;
 using ctguard::research::RUNNING;
 using ctguard::research::UNIT_TEST;
 
@@ -173,66 +174,24 @@ int main(int argc, char ** argv)
     }
 
     // parse rule file
-    if (cfg.rules_file.empty() && cfg.rules_directory.empty()) {
+    if (!cfg.builtin_rules && cfg.rules_file.empty() && cfg.rules_directory.empty()) {
         std::cerr << "No rules file or directory set!\n";
         std::cerr << "ctguard-research not started!\n";
         return EXIT_FAILURE;
     }
 
-    const rule_cfg rules = [&cfg]() {
-        rule_cfg rules_tmp;
-        if (!cfg.rules_file.empty()) {
-            try {
-                check_cfg_file_perms(cfg.rules_file);
-                parse_rules(rules_tmp, cfg.rules_file);
-            } catch (const std::exception & e) {
-                std::cerr << "Can not parse rules file '" << cfg.rules_file << "': " << e.what() << "\n";
-                std::cerr << "ctguard-research not started!\n";
-                exit(EXIT_FAILURE);
-            }
-        } else {
-            try {
-                std::set<std::string> files;
-
-                check_cfg_file_perms(cfg.rules_directory);
-
-                directory dir{ cfg.rules_directory };
-
-                for (const file_object e : dir) {
-                    if (!e.is_reg()) {
-                        continue;
-                    }
-
-                    if (e.is_hidden()) {
-                        continue;
-                    }
-
-                    files.insert(cfg.rules_directory[cfg.rules_directory.length() - 1] == '/' ? cfg.rules_directory + e.name()
-                                                                                              : cfg.rules_directory + '/' + e.name());
-                }
-
-                for (const auto & f : files) {
-                    try {
-                        check_cfg_file_perms(f);
-                        parse_rules(rules_tmp, f);
-                    } catch (const std::exception & e) {
-                        std::cerr << "Can not parse rules file '" << f << "': " << e.what() << "\n";
-                        std::cerr << "ctguard-research not started!\n";
-                        exit(EXIT_FAILURE);
-                    }
-                }
-
-            } catch (const std::exception & e) {
-                std::cerr << "Can not parse rules directory '" << cfg.rules_directory << "': " << e.what() << "\n";
-                std::cerr << "ctguard-research not started!\n";
-                exit(EXIT_FAILURE);
-            }
+    rules_load_stats load_stats;
+    const std::shared_ptr<const rule_cfg> rules = [&cfg, &load_stats]() {
+        try {
+            return std::make_shared<const rule_cfg>(load_rules(cfg, &load_stats));
+        } catch (const std::exception & e) {
+            std::cerr << e.what() << "\n";
+            std::cerr << "ctguard-research not started!\n";
+            exit(EXIT_FAILURE);
         }
-
-        return rules_tmp;
     }();
 
-    if (rules.std_rules.empty() && rules.group_rules.empty()) {
+    if (rules->std_rules.empty() && rules->group_rules.empty()) {
         std::cerr << "No rules loaded\n";
         std::cerr << "ctguard-research not started!\n";
         exit(EXIT_FAILURE);
@@ -268,6 +227,7 @@ int main(int argc, char ** argv)
 
     if (stdinput) {
         std::map<rule_id_t, struct rule_state> rules_state;
+        regex_guard guard{ cfg.regex_max_length, std::chrono::milliseconds{ cfg.regex_budget }, std::chrono::milliseconds{ cfg.slow_rule_threshold } };
         std::cout << "ctguard-research\n\n"
                   << "  Enter loginput to see its handling.\n"
                   << "   - use 'quit' to exit\n";
@@ -282,7 +242,7 @@ int main(int argc, char ** argv)
 
             source_event se;
             se.message = std::move(line);
-            const event & e = process_log(se, stdinput, rules, rules_state);
+            const event & e = process_log(se, stdinput, *rules, rules_state, guard);
             std::cout << "\nRule matched:\n"
                       << "\trule id  : " << e.rule_id() << "\n"
                       << "\tpriority : " << e.priority() << "\n"
@@ -335,6 +295,7 @@ int main(int argc, char ** argv)
     }*/
 
     FILE_LOG(log_level::INFO) << "research starting (" << VERSION << ")...";
+    FILE_LOG(log_level::INFO) << "Rules " << (load_stats.builtin ? "loaded builtin" : load_stats.from_cache ? "loaded from cache" : "parsed") << " in " << load_stats.duration.count() << "ms";
     try {
         std::ofstream output_file{ cfg.output_path, std::ios::app };
         if (!output_file.is_open()) {
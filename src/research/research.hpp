@@ -5,6 +5,8 @@
 #include <map>
 #include <mutex>
 
+#include "approx_window.hpp"
+#include "distinct_window.hpp"
 #include "rule.hpp"
 
 namespace ctguard::research {
@@ -19,6 +21,12 @@ struct rule_state
     std::time_t unless_triggered{ 0 };
     short unsigned unless_timeout{ 0 };
     event unless_event;
+    // only used by approximate activation groups
+    approx_window approx;
+    // only used by activation groups with a distinct_field
+    distinct_window distinct;
+    // set on every modification, cleared when the state task takes a snapshot
+    bool dirty{ false };
 };
 
 } /* namespace ctguard::research */
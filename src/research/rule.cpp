@@ -3,11 +3,17 @@
 #include <fstream>
 #include <regex>
 
+#include "../libs/check_file_perms.hpp"
 #include "../libs/errnoexception.hpp"
+#include "../libs/filesystem/directory.hpp"
 #include "../libs/libexception.hpp"
+#include "../libs/log_format.hpp"
 #include "../libs/logger.hpp"
 #include "../libs/parsehelper.hpp"
-#include "../libs/xml/XMLparser.hpp"
+#include "../libs/xml/XMLDocument.hpp"
+
+#include "builtin_rules.hpp"
+#include "rule_cache.hpp"
 
 namespace ctguard::research {
 
@@ -27,8 +33,10 @@ rule * find_rule(std::vector<rule> & rules, rule_id_t id)
 }
 
 template<typename T>
-static T parse_integral(const std::string & name, const std::string & content)
+static T parse_integral(std::string_view name_view, std::string_view content_view)
 {
+    const std::string name{ name_view };
+    const std::string content{ content_view };
     std::size_t pos;            // NOLINT(cppcoreguidelines-init-variables)
     unsigned long result_orig;  // NOLINT(cppcoreguidelines-init-variables,google-runtime-int)
     try {
@@ -45,7 +53,7 @@ static T parse_integral(const std::string & name, const std::string & content)
     return static_cast<T>(result_orig);
 }
 
-static bool parse_bool(const std::string & name, const std::string & content)
+static bool parse_bool(std::string_view name, std::string_view content)
 {
     if (content == "true" || content == "TRUE" || content == "True") {
         return true;
@@ -55,10 +63,10 @@ static bool parse_bool(const std::string & name, const std::string & content)
         return false;
     }
 
-    throw std::out_of_range{ "Invalid " + name + " bool value given: '" + content + "'" };
+    throw std::out_of_range{ "Invalid " + std::string{ name } + " bool value given: '" + std::string{ content } + "'" };
 }
 
-static rule_match parse_rule_match(const std::string & value)
+static rule_match parse_rule_match(std::string_view value)
 {
     if (value == "exact") {
         return rule_match::exact;
@@ -69,12 +77,22 @@ static rule_match parse_rule_match(const std::string & value)
     if (value == "empty") {
         return rule_match::empty;
     }
+    if (value == "cidr") {
+        return rule_match::cidr;
+    }
+    if (value == "list") {
+        return rule_match::list;
+    }
 
     throw std::out_of_range{ "Invalid rule_match value" };
 }
 
-static std::string trim(const std::string & str)
+static std::string trim(std::string_view str)
 {
+    if (str.empty()) {
+        return {};
+    }
+
     std::string::size_type begin = 0;
     std::string::size_type end = str.size() - 1;
     while (begin < end && std::isspace(str[begin]) != 0) {
@@ -85,7 +103,139 @@ static std::string trim(const std::string & str)
         --end;
     }
 
-    return str.substr(begin, end - begin + 1);
+    return std::string{ str.substr(begin, end - begin + 1) };
+}
+
+// List files contain one entry per line; empty lines and lines starting with '#' are ignored.
+// Relative paths are resolved against the directory of the referencing rules file.
+static std::vector<std::string> read_list_file(rule_cfg & rules, const std::string & rules_path, std::string_view list_path)
+{
+    std::string path{ list_path };
+    if (!path.empty() && path[0] != '/') {
+        const auto slash = rules_path.rfind('/');
+        if (slash != std::string::npos) {
+            path = rules_path.substr(0, slash + 1) + path;
+        }
+    }
+
+    libs::check_cfg_file_perms(path);
+    std::ifstream list_file{ path };
+    if (!list_file.is_open()) {
+        throw libs::errno_exception{ "Can not open list file '" + path + "'" };
+    }
+
+    std::vector<std::string> entries;
+    std::string line;
+    while (std::getline(list_file, line)) {
+        std::string entry = trim(line);
+        if (!entry.empty() && entry[0] != '#') {
+            entries.push_back(std::move(entry));
+        }
+    }
+    if (list_file.bad()) {
+        throw libs::errno_exception{ "Can not read list file '" + path + "'" };
+    }
+
+    rules.list_files.insert(path);
+    return entries;
+}
+
+// Inline lists are separated by commas or whitespace.
+static std::vector<std::string> split_list(std::string_view value)
+{
+    std::vector<std::string> entries;
+    std::string_view::size_type pos{ 0 };
+    while (pos < value.size()) {
+        const auto end = value.find_first_of(", \t\n", pos);
+        const auto entry = value.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos);
+        if (!entry.empty()) {
+            entries.emplace_back(entry);
+        }
+        if (end == std::string_view::npos) {
+            break;
+        }
+        pos = end + 1;
+    }
+    return entries;
+}
+
+static std::pair<std::string, field_match> parse_field_match(const libs::xml::XMLNodeView & node, rule_id_t id, rule_cfg & rules,
+                                                             const std::string & rules_path)
+{
+    std::string name;
+    std::string_view list_path;
+    field_match fm;
+    for (auto const & attr : node.attributes()) {
+        if (attr.first == "name") {
+            name = attr.second;
+
+        } else if (attr.first == "match") {
+            try {
+                fm.match = parse_rule_match(attr.second);
+            } catch (const std::exception & e) {
+                throw libs::lib_exception{ "Invalid attribute match value '" + std::string{ attr.second } + "' : " + e.what() };
+            }
+
+        } else if (attr.first == "list") {
+            list_path = attr.second;
+
+        } else {
+            throw libs::lib_exception{ "Invalid attribute for " + std::string{ node.name() } + " node: '" + std::string{ attr.first } + "'" };
+        }
+    }
+    if (name.empty()) {
+        throw libs::lib_exception{ "No name given for " + std::string{ node.name() } + " node in rule " + std::to_string(id) };
+    }
+    if (!list_path.empty() && fm.match != rule_match::cidr && fm.match != rule_match::list) {
+        throw libs::lib_exception{ "list only works with match cidr or list for " + std::string{ node.name() } + " node in rule " + std::to_string(id) };
+    }
+
+    fm.value = node.value();
+    switch (fm.match) {
+        case rule_match::exact:
+        case rule_match::empty:
+            break;
+        case rule_match::regex:
+            try {
+                fm.reg = fm.value;
+            } catch (const std::regex_error & e) {
+                throw libs::lib_exception{ "Invalid regex '" + fm.value + "' in rule " + std::to_string(id) + ": " + e.what() };
+            }
+            break;
+        case rule_match::cidr: {
+            std::vector<std::string> prefixes = split_list(fm.value);
+            if (!list_path.empty()) {
+                std::vector<std::string> listed = read_list_file(rules, rules_path, list_path);
+                prefixes.insert(prefixes.end(), std::make_move_iterator(listed.begin()), std::make_move_iterator(listed.end()));
+            }
+            if (prefixes.empty()) {
+                throw libs::lib_exception{ "No prefixes given for " + std::string{ node.name() } + " node in rule " + std::to_string(id) };
+            }
+            for (const auto & prefix : prefixes) {
+                try {
+                    fm.cidr.add(prefix);
+                } catch (const std::exception & e) {
+                    throw libs::lib_exception{ "Invalid prefix in rule " + std::to_string(id) + ": " + e.what() };
+                }
+            }
+            break;
+        }
+        case rule_match::list: {
+            std::vector<std::string> entries = split_list(fm.value);
+            if (!list_path.empty()) {
+                std::vector<std::string> listed = read_list_file(rules, rules_path, list_path);
+                entries.insert(entries.end(), std::make_move_iterator(listed.begin()), std::make_move_iterator(listed.end()));
+            }
+            if (entries.empty()) {
+                throw libs::lib_exception{ "No entries given for " + std::string{ node.name() } + " node in rule " + std::to_string(id) };
+            }
+            fm.list.reserve(entries.size());
+            fm.list.insert(std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end()));
+            break;
+        }
+    }
+
+    return { std::move(name), std::move(fm) };
 }
 
 void parse_rules(rule_cfg & rules, const std::string & rules_path)
@@ -93,32 +243,27 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
     std::vector<rule> & cfg = rules.std_rules;
     std::vector<rule> & group_rules = rules.group_rules;
 
-    std::ifstream rules_file{ rules_path };
-    if (!rules_file.is_open()) {
-        throw libs::errno_exception{ "Can not open config file '" + rules_path + "'" };
-    }
-
-    libs::xml::XMLparser p{ rules_file };
-    libs::xml::XMLNode root = p.parse();
+    const libs::xml::XMLDocument doc{ libs::xml::XMLDocument::load_file(rules_path) };
+    const libs::xml::XMLNodeView & root = doc.root();
 
     if (root.name() != "rule_group") {
-        throw libs::lib_exception{ "Expected root 'rule_group' node, got '" + root.name() + "'" };
+        throw libs::lib_exception{ "Expected root 'rule_group' node, got '" + std::string{ root.name() } + "'" };
     }
 
     if (!root.attributes().empty()) {
         const auto & attr = root.attributes().cbegin();
-        throw libs::lib_exception{ "Invalid attribute for root node: '" + attr->first + "'" };
+        throw libs::lib_exception{ "Invalid attribute for root node: '" + std::string{ attr->first } + "'" };
     }
 
     for (auto const & node : root.children()) {
         if (node.name() == "group") {
             if (!node.attributes().empty()) {
                 const auto & attr = node.attributes().cbegin();
-                throw libs::lib_exception{ "Invalid attribute for group node: '" + attr->first + "'" };
+                throw libs::lib_exception{ "Invalid attribute for group node: '" + std::string{ attr->first } + "'" };
             }
             if (!node.children().empty()) {
                 const auto & sub_node = node.children().cbegin();
-                throw libs::lib_exception{ "Invalid child for group node: '" + sub_node->name() + "'" };
+                throw libs::lib_exception{ "Invalid child for group node: '" + std::string{ sub_node->name() } + "'" };
             }
             std::string v{ trim(node.value()) };
             if (v.empty()) {
@@ -132,11 +277,11 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
         } else if (node.name() == "intervention") {
             if (!node.attributes().empty()) {
                 const auto & attr = node.attributes().cbegin();
-                throw libs::lib_exception{ "Invalid attribute for intervention node: '" + attr->first + "'" };
+                throw libs::lib_exception{ "Invalid attribute for intervention node: '" + std::string{ attr->first } + "'" };
             }
             if (!node.children().empty()) {
                 const auto & sub_node = node.children().cbegin();
-                throw libs::lib_exception{ "Invalid child for intervention node: '" + sub_node->name() + "'" };
+                throw libs::lib_exception{ "Invalid child for intervention node: '" + std::string{ sub_node->name() } + "'" };
             }
             std::string v{ trim(node.value()) };
             if (v.empty()) {
@@ -145,66 +290,7 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
             rules.interventions.insert(std::move(v));
 
         } else if (node.name() == "format") {
-            format f;
-            std::string ireg;
-
-            for (auto const & attr : node.attributes()) {
-                if (attr.first == "name") {
-                    f.m_name = attr.second;
-
-                } else {
-                    throw libs::lib_exception{ "Invalid attribute for format node: '" + attr.first + "'" };
-                }
-            }
-
-            for (auto const & sub_node : node.children()) {
-                if (sub_node.name() == "regex") {
-                    if (!sub_node.attributes().empty()) {
-                        const auto & attr = sub_node.attributes().cbegin();
-                        throw libs::lib_exception{ "Invalid attribute for format node: '" + attr->first + "'" };
-                    }
-                    ireg += sub_node.value();
-
-                } else if (sub_node.name() == "fields") {
-                    if (!sub_node.attributes().empty()) {
-                        const auto & attr = sub_node.attributes().cbegin();
-                        throw libs::lib_exception{ "Invalid attribute for fields node: '" + attr->first + "'" };
-                    }
-
-                    const std::string & fields_str = sub_node.value();
-
-                    std::size_t current = fields_str.find(',');
-                    std::size_t previous = 0;
-                    while (current != std::string::npos) {
-                        f.m_fields.push_back(trim(fields_str.substr(previous, current - previous)));
-                        previous = current + 1;
-                        current = fields_str.find(',', previous);
-                    }
-                    f.m_fields.push_back(trim(fields_str.substr(previous, current - previous)));
-
-                } else {
-                    throw libs::lib_exception{ "Unsupported format node child: " + sub_node.name() };
-                }
-            }
-
-            // validate format
-            if (f.m_name.empty()) {
-                throw libs::lib_exception{ "No name given for format" };
-            }
-            if (ireg.empty()) {
-                throw libs::lib_exception{ "No regex given for format '" + f.m_name + "'" };
-            }
-            try {
-                f.m_reg = ireg;
-                if (f.m_reg.mark_count() != f.m_fields.size()) {
-                    throw libs::lib_exception{ "Number of regex fields mismatch (" + std::to_string(f.m_reg.mark_count()) +
-                                               " != " + std::to_string(f.m_fields.size()) + ")" };
-                }
-            } catch (const std::exception & e) {
-                throw libs::lib_exception{ "Invalid regex '" + ireg + "' for format '" + f.m_name + "': " + e.what() };
-            }
-
-            rules.formats.emplace_back(f);
+            rules.formats.emplace_back(libs::parse_log_format(node));
 
         } else if (node.name() == "rule") {
             rule ex;
@@ -222,11 +308,11 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                     try {
                         ex.m_always_alert = libs::parse_bool(attr.second);
                     } catch (const std::exception & e) {
-                        throw libs::lib_exception{ "Invalid attribute value '" + attr.second + "' for '" + attr.first + "': " + e.what() };
+                        throw libs::lib_exception{ "Invalid attribute value '" + std::string{ attr.second } + "' for '" + std::string{ attr.first } + "': " + e.what() };
                     }
 
                 } else {
-                    throw libs::lib_exception{ "Invalid attribute for rule node: '" + attr.first + "'" };
+                    throw libs::lib_exception{ "Invalid attribute for rule node: '" + std::string{ attr.first } + "'" };
                 }
             }
 
@@ -234,7 +320,7 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                 if (sub_node.name() == "regex") {
                     if (!sub_node.attributes().empty()) {
                         const auto & attr = sub_node.attributes().cbegin();
-                        throw libs::lib_exception{ "Invalid attribute for regex node: '" + attr->first + "'" };
+                        throw libs::lib_exception{ "Invalid attribute for regex node: '" + std::string{ attr->first } + "'" };
                     }
                     ireg += sub_node.value();
                 }
@@ -242,10 +328,10 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                 else if (sub_node.name() == "fields") {
                     if (!sub_node.attributes().empty()) {
                         const auto & attr = sub_node.attributes().cbegin();
-                        throw libs::lib_exception{ "Invalid attribute for fields node: '" + attr->first + "'" };
+                        throw libs::lib_exception{ "Invalid attribute for fields node: '" + std::string{ attr->first } + "'" };
                     }
 
-                    const std::string & fields_str = sub_node.value();
+                    const std::string_view fields_str = sub_node.value();
 
                     std::size_t current = fields_str.find(',');
                     std::size_t previous = 0;
@@ -260,7 +346,7 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                 else if (sub_node.name() == "description") {
                     if (!sub_node.attributes().empty()) {
                         const auto & attr = sub_node.attributes().cbegin();
-                        throw libs::lib_exception{ "Invalid attribute for description node: '" + attr->first + "'" };
+                        throw libs::lib_exception{ "Invalid attribute for description node: '" + std::string{ attr->first } + "'" };
                     }
                     ex.m_description += sub_node.value();
                 }
@@ -268,11 +354,11 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                 else if (sub_node.name() == "if_rule") {
                     if (!sub_node.attributes().empty()) {
                         const auto & attr = sub_node.attributes().cbegin();
-                        throw libs::lib_exception{ "Invalid attribute for if_rule node: '" + attr->first + "'" };
+                        throw libs::lib_exception{ "Invalid attribute for if_rule node: '" + std::string{ attr->first } + "'" };
                     }
 
                     try {
-                        const std::string & ifrule_str = sub_node.value();
+                        const std::string_view ifrule_str = sub_node.value();
                         std::size_t current = ifrule_str.find(',');
                         std::size_t previous = 0;
                         while (current != std::string::npos) {
@@ -282,7 +368,7 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                         }
                         ex.m_parent_ids.push_back(libs::parse_integral<rule_id_t>(trim(ifrule_str.substr(previous, current - previous))));
                     } catch (const std::exception & e) {
-                        throw libs::lib_exception{ "Invalid if_rule setting '" + sub_node.value() + "': " + e.what() };
+                        throw libs::lib_exception{ "Invalid if_rule setting '" + std::string{ sub_node.value() } + "': " + e.what() };
                     }
                 }
 
@@ -292,7 +378,7 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                         if (attr.first == "timeout") {
                             ur.timeout = parse_integral<rule_timeout_time_t>(attr.first, attr.second);
                         } else {
-                            throw libs::lib_exception{ "Invalid attribute for unless_rule node: '" + attr.first + "'" };
+                            throw libs::lib_exception{ "Invalid attribute for unless_rule node: '" + std::string{ attr.first } + "'" };
                         }
                     }
                     unless_id = ur.id = parse_integral<rule_id_t>(sub_node.name(), sub_node.value());
@@ -302,9 +388,9 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                 else if (sub_node.name() == "group") {
                     if (!sub_node.attributes().empty()) {
                         const auto & attr = sub_node.attributes().cbegin();
-                        throw libs::lib_exception{ "Invalid attribute for group node: '" + attr->first + "'" };
+                        throw libs::lib_exception{ "Invalid attribute for group node: '" + std::string{ attr->first } + "'" };
                     }
-                    const std::string & group_str = sub_node.value();
+                    const std::string_view group_str = sub_node.value();
 
                     std::size_t current = group_str.find(',');
                     std::size_t previous = 0;
@@ -319,57 +405,17 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                 else if (sub_node.name() == "if_group") {
                     if (!sub_node.attributes().empty()) {
                         const auto & attr = sub_node.attributes().cbegin();
-                        throw libs::lib_exception{ "Invalid attribute for if_group node: '" + attr->first + "'" };
+                        throw libs::lib_exception{ "Invalid attribute for if_group node: '" + std::string{ attr->first } + "'" };
                     }
                     ex.m_trigger_group = sub_node.value();
                 }
 
                 else if (sub_node.name() == "if_field") {
-                    std::string name;
-                    rule_match rm = rule_match::exact;
-                    for (auto const & attr : sub_node.attributes()) {
-                        if (attr.first == "name") {
-                            name = attr.second;
-
-                        } else if (attr.first == "match") {
-                            try {
-                                rm = parse_rule_match(attr.second);
-                            } catch (const std::exception & e) {
-                                throw libs::lib_exception{ "Invalid attribute match value '" + attr.second + "' : " + e.what() };
-                            }
-
-                        } else {
-                            throw libs::lib_exception{ "Invalid attribute for if_field node: '" + attr.first + "'" };
-                        }
-                    }
-                    if (name.empty()) {
-                        throw libs::lib_exception{ "No name given for if_field node in rule " + std::to_string(ex.m_id) };
-                    }
-                    ex.m_trigger_fields.emplace(name, std::make_pair(rm, sub_node.value()));
+                    ex.m_trigger_fields.insert(parse_field_match(sub_node, ex.m_id, rules, rules_path));
                 }
 
                 else if (sub_node.name() == "if_trait") {
-                    std::string name;
-                    rule_match rm = rule_match::exact;
-                    for (auto const & attr : sub_node.attributes()) {
-                        if (attr.first == "name") {
-                            name = attr.second;
-
-                        } else if (attr.first == "match") {
-                            try {
-                                rm = parse_rule_match(attr.second);
-                            } catch (const std::exception & e) {
-                                throw libs::lib_exception{ "Invalid attribute match value '" + attr.second + "' : " + e.what() };
-                            }
-
-                        } else {
-                            throw libs::lib_exception{ "Invalid attribute for if_trait node: '" + attr.first + "'" };
-                        }
-                    }
-                    if (name.empty()) {
-                        throw libs::lib_exception{ "No name given for if_trait node in rule " + std::to_string(ex.m_id) };
-                    }
-                    ex.m_trigger_traits.emplace(name, std::make_pair(rm, sub_node.value()));
+                    ex.m_trigger_traits.insert(parse_field_match(sub_node, ex.m_id, rules, rules_path));
                 }
 
                 else if (sub_node.name() == "activation_group") {
@@ -381,8 +427,14 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                             ag.rate = parse_integral<rule_activation_rate_t>(attr.first, attr.second);
                         } else if (attr.first == "reset") {
                             ag.reset = parse_bool(attr.first, attr.second);
+                        } else if (attr.first == "approximate") {
+                            ag.approximate = parse_bool(attr.first, attr.second);
+                        } else if (attr.first == "escalate") {
+                            ag.escalate = parse_integral<rule_activation_rate_t>(attr.first, attr.second);
+                        } else if (attr.first == "max_memory") {
+                            ag.max_memory = parse_integral<rule_memory_t>(attr.first, attr.second);
                         } else {
-                            throw libs::lib_exception{ "Invalid attribute for activation_group node: '" + attr.first + "'" };
+                            throw libs::lib_exception{ "Invalid attribute for activation_group node: '" + std::string{ attr.first } + "'" };
                         }
                     }
                     if (ag.time == 0) {
@@ -395,18 +447,50 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                         throw libs::lib_exception{ "Invalid rate given for activation_group node in rule id " + std::to_string(ex.m_id) + ": " +
                                                    std::to_string(ag.rate) };
                     }
+                    if (ag.escalate == 0) {
+                        ag.escalate = static_cast<rule_activation_rate_t>(ag.rate / 2);
+                    }
+                    if (ag.max_memory < 16) {
+                        throw libs::lib_exception{ "Invalid max_memory given for activation_group node in rule id " + std::to_string(ex.m_id) + ": " +
+                                                   std::to_string(ag.max_memory) + " (minimum is 16)" };
+                    }
                     ag.group_name = sub_node.value();
                     ex.m_activation_group = std::move(ag);
                 }
 
+                else if (sub_node.name() == "suppress") {
+                    struct suppress_rule sr;
+                    for (auto const & attr : sub_node.attributes()) {
+                        if (attr.first == "time") {
+                            sr.time = parse_integral<rule_suppress_time_t>(attr.first, attr.second);
+                        } else if (attr.first == "field") {
+                            sr.field = attr.second;
+                        } else {
+                            throw libs::lib_exception{ "Invalid attribute for suppress node: '" + std::string{ attr.first } + "'" };
+                        }
+                    }
+                    if (sr.time == 0) {
+                        throw libs::lib_exception{ "No time given for suppress node in rule " + std::to_string(ex.m_id) };
+                    }
+                    ex.m_suppress = std::move(sr);
+                }
+
                 else if (sub_node.name() == "same_field") {
                     if (!sub_node.attributes().empty()) {
                         const auto & attr = sub_node.attributes().cbegin();
-                        throw libs::lib_exception{ "Invalid attribute for same_field node: '" + attr->first + "'" };
+                        throw libs::lib_exception{ "Invalid attribute for same_field node: '" + std::string{ attr->first } + "'" };
                     }
                     ex.m_same_field = sub_node.value();
                 }
 
+                else if (sub_node.name() == "distinct_field") {
+                    if (!sub_node.attributes().empty()) {
+                        const auto & attr = sub_node.attributes().cbegin();
+                        throw libs::lib_exception{ "Invalid attribute for distinct_field node: '" + std::string{ attr->first } + "'" };
+                    }
+                    ex.m_distinct_field = sub_node.value();
+                }
+
                 else if (sub_node.name() == "intervention") {
                     struct intervention_rule ir;
                     for (auto const & attr : sub_node.attributes()) {
@@ -420,7 +504,7 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                             ir.ignore_empty_field = parse_bool(attr.first, attr.second);
 
                         } else {
-                            throw libs::lib_exception{ "Invalid attribute for intervention node: '" + attr.first + "'" };
+                            throw libs::lib_exception{ "Invalid attribute for intervention node: '" + std::string{ attr.first } + "'" };
                         }
                     }
                     if (ir.name.empty()) {
@@ -440,7 +524,7 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
                 }
 
                 else {
-                    throw libs::lib_exception{ "Unsupported rule node child: " + sub_node.name() };
+                    throw libs::lib_exception{ "Unsupported rule node child: " + std::string{ sub_node.name() } };
                 }
             }
 
@@ -460,6 +544,15 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
             if (!ex.m_same_field.empty() && ex.m_activation_group.group_name.empty()) {
                 throw libs::lib_exception{ "same_field only works with activation_group in rule " + std::to_string(ex.m_id) };
             }
+            if (!ex.m_distinct_field.empty() && ex.m_activation_group.group_name.empty()) {
+                throw libs::lib_exception{ "distinct_field only works with activation_group in rule " + std::to_string(ex.m_id) };
+            }
+            if (!ex.m_distinct_field.empty() && ex.m_activation_group.approximate) {
+                throw libs::lib_exception{ "distinct_field does not work with an approximate activation_group in rule " + std::to_string(ex.m_id) };
+            }
+            if (ex.m_activation_group.approximate && ex.m_same_field.empty()) {
+                throw libs::lib_exception{ "approximate activation_group only works with same_field in rule " + std::to_string(ex.m_id) };
+            }
             if (ex.m_unless_rule.id != 0 && (find_rule(cfg, ex.m_unless_rule.id) == nullptr && find_rule(group_rules, ex.m_unless_rule.id) == nullptr)) {
                 throw libs::lib_exception{ "No such unless_rule in rule " + std::to_string(ex.m_id) };
             }
@@ -469,6 +562,7 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
             if (!ireg.empty()) {
                 try {
                     ex.m_reg = ireg;
+                    ex.m_reg_str = ireg;
                     if (ex.m_reg->mark_count() != ex.m_regex_fields.size()) {
                         throw libs::lib_exception{ "Number of regex fields mismatch (" + std::to_string(ex.m_reg->mark_count()) +
                                                    " != " + std::to_string(ex.m_regex_fields.size()) + ")" };
@@ -532,9 +626,113 @@ void parse_rules(rule_cfg & rules, const std::string & rules_path)
             }
 
         } else {
-            throw libs::lib_exception{ "Unexpected node, got '" + node.name() + "'" };
+            throw libs::lib_exception{ "Unexpected node, got '" + std::string{ node.name() } + "'" };
+        }
+    }
+}
+
+static std::vector<std::string> collect_rules_files(const research_config & cfg)
+{
+    if (!cfg.rules_file.empty()) {
+        return { cfg.rules_file };
+    }
+
+    std::set<std::string> files;
+    try {
+        libs::check_cfg_file_perms(cfg.rules_directory);
+
+        libs::filesystem::directory dir{ cfg.rules_directory };
+
+        for (const libs::filesystem::file_object e : dir) {
+            if (!e.is_reg()) {
+                continue;
+            }
+
+            if (e.is_hidden()) {
+                continue;
+            }
+
+            files.insert(cfg.rules_directory[cfg.rules_directory.length() - 1] == '/' ? cfg.rules_directory + e.name()
+                                                                                      : cfg.rules_directory + '/' + e.name());
+        }
+    } catch (const std::exception & e) {
+        throw libs::lib_exception{ "Can not parse rules directory '" + cfg.rules_directory + "': " + e.what() };
+    }
+
+    return { files.begin(), files.end() };
+}
+
+rule_cfg load_rules(const research_config & cfg, rules_load_stats * stats)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    if (cfg.builtin_rules) {
+        std::optional<rule_cfg> builtin{ builtin_rules() };
+        if (!builtin.has_value()) {
+            throw libs::lib_exception{ "No builtin rules compiled in" };
+        }
+        if (stats != nullptr) {
+            stats->builtin = true;
+            stats->duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        }
+        return std::move(*builtin);
+    }
+
+    const std::vector<std::string> files{ collect_rules_files(cfg) };
+
+    rule_cache_key key;
+    for (const auto & f : files) {
+        try {
+            libs::check_cfg_file_perms(f);
+            if (!cfg.rules_cache.empty()) {
+                key.rule_files.emplace_back(f, hash_rules_file(f));
+            }
+        } catch (const std::exception & e) {
+            throw libs::lib_exception{ "Can not parse rules file '" + f + "': " + e.what() };
+        }
+    }
+
+    if (!cfg.rules_cache.empty()) {
+        try {
+            std::optional<rule_cfg> cached{ read_rule_cache(cfg.rules_cache, key) };
+            if (cached.has_value()) {
+                if (stats != nullptr) {
+                    stats->from_cache = true;
+                    stats->duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+                }
+                return std::move(*cached);
+            }
+        } catch (const std::exception & e) {
+            FILE_LOG(libs::log_level::WARNING) << "Ignoring rules cache '" << cfg.rules_cache << "': " << e.what();
         }
     }
+
+    rule_cfg rules;
+    for (const auto & f : files) {
+        try {
+            parse_rules(rules, f);
+        } catch (const std::exception & e) {
+            throw libs::lib_exception{ "Can not parse rules file '" + f + "': " + e.what() };
+        }
+    }
+
+    if (!cfg.rules_cache.empty()) {
+        try {
+            for (const auto & f : rules.list_files) {
+                key.list_files.emplace_back(f, hash_rules_file(f));
+            }
+            write_rule_cache(cfg.rules_cache, key, rules);
+        } catch (const std::exception & e) {
+            FILE_LOG(libs::log_level::WARNING) << "Can not write rules cache: " << e.what();
+        }
+    }
+
+    if (stats != nullptr) {
+        stats->from_cache = false;
+        stats->duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    }
+
+    return rules;
 }
 
 } /* namespace ctguard::research */
@@ -1,12 +1,17 @@
 #pragma once
 
+#include "../libs/log_format.hpp"
+#include "cidr_set.hpp"
 #include "config.hpp"
 #include "event.hpp"
 
+#include <chrono>
 #include <map>
+#include <optional>
 #include <regex>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 namespace ctguard::research {
@@ -20,11 +25,21 @@ struct rule_cfg
     std::set<std::string> groups;
     std::vector<format> formats;
     std::set<std::string> interventions;
+    // list files referenced by the rules, part of the rules cache key
+    std::set<std::string> list_files;
+
+    template<class Archive>
+    void serialize(Archive & archive)
+    {
+        archive(std_rules, group_rules, groups, formats, interventions, list_files);
+    }
 };
 
 using rule_activation_time_t = unsigned short;
 using rule_activation_rate_t = unsigned short;
 using rule_timeout_time_t = unsigned short;
+using rule_suppress_time_t = unsigned short;
+using rule_memory_t = unsigned int;
 
 struct activation_group
 {
@@ -32,19 +47,74 @@ struct activation_group
     rule_activation_rate_t rate{ 0 };
     std::string group_name;
     bool reset{ false };
+    // count events in sketches instead of saving them, see approx_window
+    bool approximate{ false };
+    rule_activation_rate_t escalate{ 0 };
+    rule_memory_t max_memory{ 256 };  // KiB
+
+    template<class Archive>
+    void serialize(Archive & archive)
+    {
+        archive(time, rate, group_name, reset, approximate, escalate, max_memory);
+    }
 };
 
 struct unless_rule
 {
     rule_id_t id{ 0 };
     rule_timeout_time_t timeout{ 0 };
+
+    template<class Archive>
+    void serialize(Archive & archive)
+    {
+        archive(id, timeout);
+    }
+};
+
+struct suppress_rule
+{
+    rule_suppress_time_t time{ 0 };
+    std::string field;
+
+    template<class Archive>
+    void serialize(Archive & archive)
+    {
+        archive(time, field);
+    }
 };
 
 enum class rule_match
 {
     exact,
     regex,
-    empty
+    empty,
+    cidr,
+    list
+};
+
+// Condition of an if_field or if_trait node; regex, cidr and list matches are prepared at load time.
+struct field_match
+{
+    rule_match match{ rule_match::exact };
+    std::string value;
+    std::optional<std::regex> reg;
+    cidr_set cidr;
+    std::unordered_set<std::string> list;
+
+    template<class Archive>
+    void save(Archive & archive) const
+    {
+        archive(match, value, cidr, list);
+    }
+
+    template<class Archive>
+    void load(Archive & archive)
+    {
+        archive(match, value, cidr, list);
+        if (match == rule_match::regex) {
+            reg = value;
+        }
+    }
 };
 
 class rule
@@ -62,13 +132,33 @@ class rule
     const std::vector<rule_id_t> & parent_ids() const { return m_parent_ids; }
     bool always_alert() const { return m_always_alert; }
     const std::string & trigger_group() const { return m_trigger_group; }
-    const std::map<std::string, std::pair<rule_match, std::string>> & trigger_fields() const { return m_trigger_fields; }
-    const std::map<std::string, std::pair<rule_match, std::string>> & trigger_traits() const { return m_trigger_traits; }
+    const std::map<std::string, field_match> & trigger_fields() const { return m_trigger_fields; }
+    const std::map<std::string, field_match> & trigger_traits() const { return m_trigger_traits; }
     const struct activation_group & activation_group() const { return m_activation_group; }
     const std::string & same_field() const { return m_same_field; }
+    const std::string & distinct_field() const { return m_distinct_field; }
     const struct unless_rule & unless_rule() const { return m_unless_rule; }
+    const struct suppress_rule & suppress() const { return m_suppress; }
     const std::vector<struct intervention_rule> & interventions() const noexcept { return m_intervention_rules; }
 
+    // std::regex is not serializable, so only its pattern is stored and recompiled on load
+    template<class Archive>
+    void save(Archive & archive) const
+    {
+        archive(m_id, m_parent_ids, m_priority, m_always_alert, m_description, m_groups, m_reg_str, m_regex_fields, m_children, m_trigger_group, m_trigger_fields,
+                m_trigger_traits, m_activation_group, m_same_field, m_distinct_field, m_unless_rule, m_suppress, m_intervention_rules);
+    }
+
+    template<class Archive>
+    void load(Archive & archive)
+    {
+        archive(m_id, m_parent_ids, m_priority, m_always_alert, m_description, m_groups, m_reg_str, m_regex_fields, m_children, m_trigger_group, m_trigger_fields,
+                m_trigger_traits, m_activation_group, m_same_field, m_distinct_field, m_unless_rule, m_suppress, m_intervention_rules);
+        if (!m_reg_str.empty()) {
+            m_reg = m_reg_str;
+        }
+    }
+
   private:
     rule_id_t m_id{ 0 };
     std::vector<rule_id_t> m_parent_ids;
@@ -77,19 +167,23 @@ class rule
     std::string m_description;
     std::set<std::string> m_groups;
     std::optional<std::regex> m_reg;
+    std::string m_reg_str;
     std::vector<std::string> m_regex_fields;
 
     std::vector<rule> m_children;
 
     std::string m_trigger_group;
-    std::map<std::string, std::pair<rule_match, std::string>> m_trigger_fields;
-    std::map<std::string, std::pair<rule_match, std::string>> m_trigger_traits;
+    std::map<std::string, field_match> m_trigger_fields;
+    std::map<std::string, field_match> m_trigger_traits;
 
     struct activation_group m_activation_group;
     std::string m_same_field;
+    std::string m_distinct_field;
 
     struct unless_rule m_unless_rule;
 
+    struct suppress_rule m_suppress;
+
     std::vector<struct intervention_rule> m_intervention_rules;
 
     friend void parse_rules(rule_cfg & rules, const std::string & rules_path);
@@ -100,19 +194,46 @@ class format
 {
   public:
     format() = default;
+    explicit format(libs::log_format def)
+      : m_name{ std::move(def.name) }, m_reg{ std::move(def.reg) }, m_reg_str{ std::move(def.regex) }, m_fields{ std::move(def.fields) }
+    {}
 
     const std::string & name() const { return m_name; }
     const std::regex & reg() const { return m_reg; }
     const std::vector<std::string> & fields() const { return m_fields; }
 
+    template<class Archive>
+    void save(Archive & archive) const
+    {
+        archive(m_name, m_reg_str, m_fields);
+    }
+
+    template<class Archive>
+    void load(Archive & archive)
+    {
+        archive(m_name, m_reg_str, m_fields);
+        m_reg = m_reg_str;
+    }
+
   private:
     std::string m_name;
     std::regex m_reg;
+    std::string m_reg_str;
     std::vector<std::string> m_fields;
-
-    friend void parse_rules(rule_cfg & rules, const std::string & rules_path);
 };
 
 void parse_rules(rule_cfg & rules, const std::string & rules_path);
 
+struct rules_load_stats
+{
+    bool builtin{ false };
+    bool from_cache{ false };
+    std::chrono::milliseconds duration{ 0 };
+};
+
+// Load all rules from the configured rules file or rules directory; throws on any error.
+// If builtin rules are configured, the rules compiled in are used instead.
+// If a rules cache is configured and matches the content hashes of all rule files, the rules are restored from it instead of parsed.
+[[nodiscard]] rule_cfg load_rules(const research_config & cfg, rules_load_stats * stats = nullptr);
+
 } /* namespace ctguard::research */
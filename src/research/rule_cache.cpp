@@ -0,0 +1,181 @@
+#include "rule_cache.hpp"
+
+#include <fcntl.h>
+#include <sha2.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>  // std::rename
+#include <fstream>
+#include <sstream>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/array.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/set.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/unordered_set.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "../libs/check_file_perms.hpp"
+#include "../libs/errnoexception.hpp"
+#include "../libs/libexception.hpp"
+#include "../libs/scopeguard.hpp"
+
+namespace ctguard::research {
+
+static constexpr std::array<char, 8> CACHE_MAGIC{ 'C', 'T', 'G', 'R', 'R', 'U', 'L', 'E' };
+// bump on every change of the serialized rule layout
+static constexpr std::uint32_t CACHE_VERSION{ 7 };
+
+std::string hash_rules_file(const std::string & path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    if (fd == -1) {
+        throw libs::errno_exception{ "Can not open '" + path + "'" };
+    }
+
+    libs::scope_guard sg{ [fd]() { ::close(fd); } };
+
+    ssize_t ret;  // NOLINT(cppcoreguidelines-init-variables)
+    SHA256_CTX ctx;
+    SHA256_Init(&ctx);
+
+    std::array<unsigned char, 16384> buffer;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+
+    while ((ret = ::read(fd, buffer.data(), buffer.size())) > 0) {
+        SHA256_Update(&ctx, buffer.data(), static_cast<size_t>(ret));
+    }
+
+    if (ret == -1) {
+        throw libs::errno_exception{ "Can not read '" + path + "'" };
+    }
+
+    std::array<char, SHA256_DIGEST_STRING_LENGTH> result;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    SHA256_End(&ctx, result.data());
+
+    return result.data();
+}
+
+std::optional<rule_cfg> read_rule_cache(const std::string & path, const rule_cache_key & key)
+{
+    std::ifstream cache_file{ path, std::ios::in | std::ios::binary };
+    if (!cache_file.is_open()) {
+        if (errno == ENOENT) {
+            return std::nullopt;
+        }
+        throw libs::errno_exception{ "Can not open rules cache '" + path + "'" };
+    }
+
+    // the cache is trusted like the rule files themselves
+    struct ::stat info;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    if (::stat(path.c_str(), &info) == -1) {
+        throw libs::errno_exception{ "Can not stat rules cache '" + path + "'" };
+    }
+    if (info.st_uid != ::geteuid() || (info.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+        throw libs::lib_exception{ "Insecure rules cache '" + path + "'" };
+    }
+
+    std::array<char, CACHE_MAGIC.size()> magic;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    if (!cache_file.read(magic.data(), magic.size()) || magic != CACHE_MAGIC) {
+        throw libs::lib_exception{ "Invalid rules cache header" };
+    }
+
+    cereal::BinaryInputArchive iarchive{ cache_file };
+
+    std::uint32_t version;  // NOLINT(cppcoreguidelines-init-variables)
+    iarchive(version);
+    if (version != CACHE_VERSION) {
+        return std::nullopt;
+    }
+
+    rule_cache_key cached_key;
+    iarchive(cached_key);
+    if (cached_key.rule_files != key.rule_files) {
+        return std::nullopt;
+    }
+    for (const auto & [list_path, list_hash] : cached_key.list_files) {
+        // same check as on parsing the list file
+        libs::check_cfg_file_perms(list_path);
+        try {
+            if (hash_rules_file(list_path) != list_hash) {
+                return std::nullopt;
+            }
+        } catch (const std::exception &) {
+            return std::nullopt;
+        }
+    }
+
+    rule_cfg rules;
+    iarchive(rules);
+
+    return rules;
+}
+
+void write_rule_cache(const std::string & path, const rule_cache_key & key, const rule_cfg & rules)
+{
+    const std::string path_tmp = path + ".tmp";
+
+    {
+        std::ofstream cache_file{ path_tmp, std::ios::out | std::ios::trunc | std::ios::binary };
+        if (!cache_file.is_open()) {
+            throw libs::errno_exception{ "Can not open rules cache '" + path_tmp + "'" };
+        }
+
+        cache_file.write(CACHE_MAGIC.data(), CACHE_MAGIC.size());
+        {
+            cereal::BinaryOutputArchive oarchive{ cache_file };
+            oarchive(CACHE_VERSION, key, rules);
+        }
+
+        cache_file.close();
+        if (cache_file.fail()) {
+            throw libs::errno_exception{ "Can not write rules cache '" + path_tmp + "'" };
+        }
+    }
+
+    if (std::rename(path_tmp.c_str(), path.c_str()) == -1) {
+        throw libs::errno_exception{ "Can not rename '" + path_tmp + "' to '" + path + "'" };
+    }
+}
+
+std::string write_rule_image(const rule_cfg & rules)
+{
+    std::ostringstream image{ std::ios::out | std::ios::binary };
+
+    image.write(CACHE_MAGIC.data(), CACHE_MAGIC.size());
+    {
+        cereal::BinaryOutputArchive oarchive{ image };
+        oarchive(CACHE_VERSION, rules);
+    }
+
+    return image.str();
+}
+
+rule_cfg read_rule_image(std::string_view image)
+{
+    if (image.size() < CACHE_MAGIC.size() || !std::equal(CACHE_MAGIC.begin(), CACHE_MAGIC.end(), image.begin())) {
+        throw libs::lib_exception{ "Invalid rules image header" };
+    }
+
+    std::istringstream input{ std::string{ image.substr(CACHE_MAGIC.size()) }, std::ios::in | std::ios::binary };
+    cereal::BinaryInputArchive iarchive{ input };
+
+    std::uint32_t version;  // NOLINT(cppcoreguidelines-init-variables)
+    iarchive(version);
+    if (version != CACHE_VERSION) {
+        throw libs::lib_exception{ "Unsupported rules image version " + std::to_string(version) };
+    }
+
+    rule_cfg rules;
+    iarchive(rules);
+
+    return rules;
+}
+
+} /* namespace ctguard::research */
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "rule.hpp"
+
+namespace ctguard::research {
+
+struct rule_cache_key
+{
+    // Rule files with the sha256 sum of their content, in parse order; must match exactly.
+    std::vector<std::pair<std::string, std::string>> rule_files;
+    // List files referenced by the rules, only known after parsing; re-checked on read.
+    std::vector<std::pair<std::string, std::string>> list_files;
+
+    template<class Archive>
+    void serialize(Archive & archive)
+    {
+        archive(rule_files, list_files);
+    }
+};
+
+[[nodiscard]] std::string hash_rules_file(const std::string & path);
+
+// Returns the cached rules if the cache at path was created for key; throws on read errors.
+[[nodiscard]] std::optional<rule_cfg> read_rule_cache(const std::string & path, const rule_cache_key & key);
+
+// Atomically replace the cache at path; throws on error.
+void write_rule_cache(const std::string & path, const rule_cache_key & key, const rule_cfg & rules);
+
+// Binary image of rules, as embedded into research by the builtin ruleset.
+[[nodiscard]] std::string write_rule_image(const rule_cfg & rules);
+
+// Restore rules from an image created by write_rule_image(); throws on error.
+[[nodiscard]] rule_cfg read_rule_image(std::string_view image);
+
+} /* namespace ctguard::research */
@@ -0,0 +1,74 @@
+// Build time generator of the builtin ruleset:
+// parses the given rule files and writes a C++ source embedding the binary rules image.
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "rule.hpp"
+#include "rule_cache.hpp"
+
+using ctguard::research::parse_rules;
+using ctguard::research::rule_cfg;
+using ctguard::research::write_rule_image;
+
+int main(int argc, char ** argv)
+{
+    if (argc < 3) {
+        std::cerr << "usage: ctguard-research-rulegen OUTPUT RULESFILE...\n";
+        return EXIT_FAILURE;
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    const std::string output_path{ argv[1] };
+
+    rule_cfg rules;
+    for (int i = 2; i < argc; ++i) {
+        const std::string rules_path{ argv[i] };  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        try {
+            parse_rules(rules, rules_path);
+        } catch (const std::exception & e) {
+            std::cerr << "Can not parse rules file '" << rules_path << "': " << e.what() << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (rules.std_rules.empty() && rules.group_rules.empty()) {
+        std::cerr << "No rules loaded\n";
+        return EXIT_FAILURE;
+    }
+
+    const std::string image{ write_rule_image(rules) };
+
+    std::ofstream output{ output_path, std::ios::out | std::ios::trunc };
+    if (!output.is_open()) {
+        std::cerr << "Can not open '" << output_path << "'\n";
+        return EXIT_FAILURE;
+    }
+
+    output << "// generated by ctguard-research-rulegen, do not edit\n"
+           << "// NOLINTBEGIN\n"
+           << "#include <cstddef>\n\n"
+           << "namespace ctguard::research {\n\n"
+           << "extern const unsigned char BUILTIN_RULES_DATA[];\n"
+           << "extern const std::size_t BUILTIN_RULES_SIZE;\n\n"
+           << "const unsigned char BUILTIN_RULES_DATA[] = {";
+    output << std::hex << std::setfill('0');
+    for (std::size_t i = 0; i < image.size(); ++i) {
+        output << (i % 16 == 0 ? "\n    " : " ") << "0x" << std::setw(2) << static_cast<unsigned>(static_cast<unsigned char>(image[i])) << ",";
+    }
+    output << std::dec << "\n};\n"
+           << "const std::size_t BUILTIN_RULES_SIZE = sizeof BUILTIN_RULES_DATA;\n\n"
+           << "} /* namespace ctguard::research */\n"
+           << "// NOLINTEND\n";
+
+    output.close();
+    if (output.fail()) {
+        std::cerr << "Can not write '" << output_path << "'\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
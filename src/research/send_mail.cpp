@@ -3,82 +3,206 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <strings.h>  // ::strncasecmp
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <cstring>
-#include <iomanip>
+#include <sstream>
 
 #include "../libs/errnoexception.hpp"
 #include "../libs/libexception.hpp"
-#include "../libs/scopeguard.hpp"
+#include "../libs/logger.hpp"
 
 namespace ctguard::research {
 
-static void send_cmd(int socket, const std::string & cmd, const std::string & return_code)
+smtp_body_buf::smtp_body_buf(smtp_session & session) : m_session{ session }
 {
-    std::array<char, 2048> buffer;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    setp(m_raw.data(), m_raw.data() + m_raw.size());  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
 
-    if (::send(socket, cmd.c_str(), cmd.length(), 0) == -1) {
-        throw libs::errno_exception{ "Can not send command '" + cmd + "'" };
-    }
+void smtp_body_buf::reset() noexcept
+{
+    setp(m_raw.data(), m_raw.data() + m_raw.size());  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    m_encoded_used = 0;
+    m_line_start = true;
+}
 
-    const ssize_t ret = ::recv(socket, buffer.data(), buffer.size(), 0);
-    if (ret < 0) {
-        throw libs::errno_exception{ "Can not receive response for command '" + cmd };
+void smtp_body_buf::put_encoded(char c)
+{
+    // room for a stuffed dot or a CRLF
+    if (m_encoded_used + 2 > m_encoded.size()) {
+        send_encoded();
     }
 
-    if (static_cast<size_t>(ret) >= buffer.size() - 1) {
-        throw libs::lib_exception{ "Receive buffer for command '" + cmd + "' too short: " + std::to_string(ret) + "/" + std::to_string(buffer.size()) };
+    switch (c) {
+        case '\r':
+            // bare carriage returns are not allowed in SMTP data
+            return;
+        case '\n':
+            m_encoded[m_encoded_used++] = '\r';  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+            m_encoded[m_encoded_used++] = '\n';  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+            m_line_start = true;
+            return;
+        case '.':
+            if (m_line_start) {
+                m_encoded[m_encoded_used++] = '.';  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+            }
+            break;
+        default:
+            break;
     }
 
-    buffer[static_cast<std::size_t>(ret)] = '\0';  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+    m_encoded[m_encoded_used++] = c;  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+    m_line_start = false;
+}
+
+void smtp_body_buf::encode_pending()
+{
+    for (const char * p = pbase(); p != pptr(); ++p) {  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        put_encoded(*p);
+    }
+    setp(m_raw.data(), m_raw.data() + m_raw.size());  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
 
-    if (return_code.compare(0, return_code.length(), buffer.data(), 0, return_code.length()) != 0) {
-        throw libs::lib_exception{ "Command '" + cmd + "' does not return '" + return_code + "', instead it returns '" + buffer.data() + "'" };
+void smtp_body_buf::send_encoded()
+{
+    if (m_encoded_used == 0) {
+        return;
     }
+
+    m_session.write(m_encoded.data(), m_encoded_used);
+    m_encoded_used = 0;
 }
 
-static void send_mail_message(int socket, const std::string & from, const std::string & to, const std::string & subject, const std::string & replyto,
-                              const std::string & msg, const std::string & return_code)
+smtp_body_buf::int_type smtp_body_buf::overflow(int_type ch)
 {
-    std::ostringstream oss;
+    encode_pending();
 
-    oss << "From: " << from << "\r\nTo: " << to << "\r\nSubject: " << subject << "\r\nX-Mailer: ctguard-notifier\r\nReply-To: " << replyto << "\r\n\r\n";
-    const std::string envelop{ oss.str() };
-    if (::send(socket, envelop.c_str(), envelop.length(), 0) == -1) {
-        throw libs::errno_exception{ "Can not send evelop '" + envelop + "'" };
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        put_encoded(traits_type::to_char_type(ch));
     }
 
-    if (::send(socket, msg.c_str(), msg.length(), 0) == -1) {
-        throw libs::errno_exception{ "Can not send message '" + msg + "'" };
+    return traits_type::not_eof(ch);
+}
+
+int smtp_body_buf::sync()
+{
+    encode_pending();
+    send_encoded();
+    return 0;
+}
+
+void smtp_body_buf::finish()
+{
+    encode_pending();
+    if (!m_line_start) {
+        put_encoded('\n');
     }
+    send_encoded();
+}
+
+smtp_session::smtp_session(std::string host, std::string port, unsigned keepalive)
+  : m_host{ std::move(host) }, m_port{ std::move(port) }, m_keepalive{ keepalive }, m_body_buf{ *this }, m_body{ &m_body_buf }
+{
+    // errors of the body buffer are rethrown to the writer
+    m_body.exceptions(std::ios::badbit);
+}
+
+smtp_session::~smtp_session() { quit(); }
 
-    const std::string terminator{ "\r\n.\r\n" };
-    if (::send(socket, terminator.c_str(), terminator.length(), 0) == -1) {
-        throw libs::errno_exception{ "Can not send the message terminator" };
+void smtp_session::close() noexcept
+{
+    if (m_socket != -1) {
+        ::close(m_socket);
+        m_socket = -1;
     }
+    m_rbuf_used = 0;
+    m_pipelining = false;
+}
+
+void smtp_session::write(const char * data, std::size_t len)
+{
+    while (len > 0) {
+        // MSG_NOSIGNAL: the server might have dropped the connection meanwhile
+        const ssize_t ret = ::send(m_socket, data, len, MSG_NOSIGNAL);
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            const libs::errno_exception e{ "Can not send data to mail server" };
+            close();
+            throw e;
+        }
 
-    std::array<char, 256> buffer;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
-    const ssize_t ret = recv(socket, buffer.data(), buffer.size(), 0);
-    if (ret < 0) {
-        throw libs::errno_exception{ "Can not receive message id" };
+        data += ret;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        len -= static_cast<std::size_t>(ret);
     }
+}
+
+std::string smtp_session::read_line()
+{
+    for (;;) {
+        const char * end = static_cast<const char *>(::memchr(m_rbuf.data(), '\n', m_rbuf_used));
+        if (end != nullptr) {
+            const auto len = static_cast<std::size_t>(end - m_rbuf.data());
+            std::string line{ m_rbuf.data(), (len > 0 && m_rbuf[len - 1] == '\r') ? len - 1 : len };  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+            m_rbuf_used -= len + 1;
+            ::memmove(m_rbuf.data(), end + 1, m_rbuf_used);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            return line;
+        }
+
+        if (m_rbuf_used == m_rbuf.size()) {
+            close();
+            throw libs::lib_exception{ "Response line of mail server too long: " + std::to_string(m_rbuf.size()) };
+        }
 
-    if (static_cast<size_t>(ret) >= buffer.size() - 1) {
-        throw libs::lib_exception{ "Receive buffer for mail message data too short: " + std::to_string(ret) + "/" + std::to_string(buffer.size()) };
+        const ssize_t ret = ::recv(m_socket, m_rbuf.data() + m_rbuf_used, m_rbuf.size() - m_rbuf_used, 0);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            const libs::errno_exception e{ "Can not receive response from mail server" };
+            close();
+            throw e;
+        }
+        if (ret == 0) {
+            close();
+            throw libs::lib_exception{ "Mail server closed the connection" };
+        }
+
+        m_rbuf_used += static_cast<std::size_t>(ret);
     }
+}
+
+std::string smtp_session::expect(const std::string & cmd, int code)
+{
+    const std::string code_str{ std::to_string(code) };
+    std::string text;
 
-    buffer[static_cast<std::size_t>(ret)] = '\0';  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+    for (;;) {
+        const std::string line{ read_line() };
 
-    if (return_code.compare(0, return_code.length(), buffer.data(), 0, return_code.length()) != 0) {
-        throw libs::lib_exception{ "Mail message data does not return '" + return_code + "', instead it returns '" + buffer.data() + "'" };
+        if (line.compare(0, 3, code_str) != 0) {
+            close();
+            throw libs::lib_exception{ "Command '" + cmd + "' does not return '" + code_str + "', instead it returns '" + line + "'" };
+        }
+
+        if (line.length() > 4) {
+            text += line.substr(4);
+            text += '\n';
+        }
+
+        // multiline responses continue with '-' after the code
+        if (line.length() < 4 || line[3] != '-') {
+            return text;
+        }
     }
 }
 
-void send_mail(const std::string & smtpserver, const std::string & smtpport, const std::string & from, const std::string & to, const std::string & subject,
-               const std::string & replyto, const std::string & msg)
+void smtp_session::connect()
 {
     struct ::addrinfo hints = {};
     hints.ai_family = AF_UNSPEC;
@@ -87,52 +211,147 @@ void send_mail(const std::string & smtpserver, const std::string & smtpport, con
     hints.ai_protocol = 0;
 
     struct ::addrinfo * result;  // NOLINT(cppcoreguidelines-init-variables)
-    if (const auto s = ::getaddrinfo(smtpserver.c_str(), smtpport.c_str(), &hints, &result); s != 0) {
-        throw libs::lib_exception{ "Can not get address information for '" + smtpserver + ":" + smtpport + "': " + ::gai_strerror(s) };
+    if (const auto s = ::getaddrinfo(m_host.c_str(), m_port.c_str(), &hints, &result); s != 0) {
+        throw libs::lib_exception{ "Can not get address information for '" + m_host + ":" + m_port + "': " + ::gai_strerror(s) };
     }
 
-    int socket = -1;  // TODO(cgzones): raii class
     const struct ::addrinfo * rp = result;
     for (; rp != nullptr; rp = rp->ai_next) {
-        socket = ::socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
-        if (socket == -1) {
+        m_socket = ::socket(rp->ai_family, rp->ai_socktype | SOCK_CLOEXEC, rp->ai_protocol);
+        if (m_socket == -1) {
             continue;
         }
 
-        if (::connect(socket, rp->ai_addr, rp->ai_addrlen) != 1) {
+        if (::connect(m_socket, rp->ai_addr, rp->ai_addrlen) == 0) {
             break;  // success
         }
 
-        ::close(socket);
+        ::close(m_socket);
+        m_socket = -1;
     }
 
+    ::freeaddrinfo(result);
+
     if (rp == nullptr) {
-        ::freeaddrinfo(result);
-        throw libs::lib_exception{ "Can not connect to '" + smtpserver + ":" + smtpport + "'" };
+        throw libs::lib_exception{ "Can not connect to '" + m_host + ":" + m_port + "'" };
     }
 
-    ::freeaddrinfo(result);
-    libs::scope_guard sg{ [socket]() { ::close(socket); } };
-
+    // do not block the mail thread forever on a stalled server
+    const struct timeval tv
     {
-        std::array<char, 4096> buffer;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
-        if (::recv(socket, buffer.data(), buffer.size(), 0) == -1) {
-            throw libs::errno_exception{ "Can not receive welcome message" };
+        30, 0
+    };  // 30s
+    ::setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+    ::setsockopt(m_socket, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof tv);
+
+    expect("welcome", 220);
+
+    std::array<char, 512> buffer_hostname{};
+    ::gethostname(buffer_hostname.data(), buffer_hostname.size() - 1);
+    write(std::string("EHLO ") + buffer_hostname.data() + "\r\n");
+
+    std::istringstream extensions{ expect("EHLO", 250) };
+    for (std::string line; std::getline(extensions, line);) {
+        if (::strncasecmp(line.c_str(), "PIPELINING", 10) == 0 && (line.length() == 10 || line[10] == ' ')) {
+            m_pipelining = true;
         }
     }
 
-    {
-        std::array<char, 512> buffer_hostname;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
-        ::gethostname(buffer_hostname.data(), buffer_hostname.size());
+    FILE_LOG(libs::log_level::DEBUG) << "[mq] connected to mail server " << m_host << ":" << m_port << (m_pipelining ? " with pipelining" : "");
+}
+
+void smtp_session::send_envelope(const std::string & from, const std::string & to)
+{
+    const std::string mail_cmd{ "MAIL FROM:<" + from + ">\r\n" };
+    const std::string rcpt_cmd{ "RCPT TO:<" + to + ">\r\n" };
+    const std::string data_cmd{ "DATA\r\n" };
+
+    if (m_pipelining) {
+        write(mail_cmd + rcpt_cmd + data_cmd);
+        expect(mail_cmd, 250);
+        expect(rcpt_cmd, 250);
+        expect(data_cmd, 354);
+        return;
+    }
+
+    write(mail_cmd);
+    expect(mail_cmd, 250);
+    write(rcpt_cmd);
+    expect(rcpt_cmd, 250);
+    write(data_cmd);
+    expect(data_cmd, 354);
+}
+
+std::ostream & smtp_session::start_mail(const std::string & from, const std::string & to, const std::string & subject, const std::string & replyto)
+{
+    const bool reused = connected();
+    if (!reused) {
+        connect();
+    }
+
+    try {
+        send_envelope(from, to);
+    } catch (const std::exception & e) {
+        if (!reused) {
+            throw;
+        }
 
-        send_cmd(socket, std::string("EHLO ") + buffer_hostname.data() + "\r\n", "250");
+        // the server might have dropped the idle connection
+        FILE_LOG(libs::log_level::DEBUG) << "[mq] reconnecting to mail server: " << e.what();
+        close();
+        connect();
+        send_envelope(from, to);
     }
 
-    send_cmd(socket, "MAIL From:<" + from + ">\r\n", "250");
-    send_cmd(socket, "RCPT To:<" + to + ">\r\n", "250");
-    send_cmd(socket, "DATA\r\n", "354");
-    send_mail_message(socket, from, to, subject, replyto, msg, "250");
-    send_cmd(socket, "QUIT\r\n", "221");
+    m_body_buf.reset();
+    m_body.clear();
+    m_body << "From: " << from << "\nTo: " << to << "\nSubject: " << subject << "\nX-Mailer: ctguard-notifier\nReply-To: " << replyto << "\n\n";
+
+    return m_body;
+}
+
+void smtp_session::finish_mail()
+{
+    m_body_buf.finish();
+    write(".\r\n");
+    expect("message data", 250);
+
+    m_last_used = std::time(nullptr);
+    if (m_keepalive == 0) {
+        quit();
+    }
+}
+
+void smtp_session::idle(std::time_t now)
+{
+    if (connected() && now >= m_last_used + static_cast<std::time_t>(m_keepalive)) {
+        FILE_LOG(libs::log_level::DEBUG) << "[mq] closing idle connection to mail server";
+        quit();
+    }
+}
+
+void smtp_session::quit() noexcept
+{
+    if (!connected()) {
+        return;
+    }
+
+    try {
+        write("QUIT\r\n");
+        expect("QUIT", 221);
+    } catch (const std::exception & e) {
+        FILE_LOG(libs::log_level::DEBUG) << "[mq] can not quit mail server session: " << e.what();
+    }
+
+    close();
+}
+
+void send_mail(const std::string & smtpserver, const std::string & smtpport, const std::string & from, const std::string & to, const std::string & subject,
+               const std::string & replyto, const std::string & msg)
+{
+    smtp_session session{ smtpserver, smtpport, 0 };
+    session.start_mail(from, to, subject, replyto) << msg;
+    session.finish_mail();
 }
 
 } /* namespace ctguard::research */
@@ -1,9 +1,95 @@
 #pragma once
 
+#include <array>
+#include <ctime>
+#include <ostream>
 #include <string>
 
 namespace ctguard::research {
 
+class smtp_session;
+
+// Output buffer for the DATA section of a mail: converts line endings to CRLF, dot-stuffs lines
+// and sends the encoded data once its fixed size buffer is full.
+class smtp_body_buf final : public std::streambuf
+{
+  public:
+    explicit smtp_body_buf(smtp_session & session);
+
+    // Discard pending data of an aborted mail.
+    void reset() noexcept;
+
+    // Send the pending data and terminate the last line.
+    void finish();
+
+  protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+  private:
+    smtp_session & m_session;
+    std::array<char, 1024> m_raw{};
+    std::array<char, 4096> m_encoded{};
+    std::size_t m_encoded_used{ 0 };
+    bool m_line_start{ true };
+
+    void encode_pending();
+    void put_encoded(char c);
+    void send_encoded();
+};
+
+// SMTP connection kept open between mails; commands are pipelined if the server offers PIPELINING.
+// Any error closes the connection, the next mail reconnects.
+class smtp_session
+{
+  public:
+    // Connections idle for keepalive seconds are closed; 0 closes the connection after each mail.
+    smtp_session(std::string host, std::string port, unsigned keepalive);
+    ~smtp_session();
+
+    smtp_session(const smtp_session &) = delete;
+    smtp_session & operator=(const smtp_session &) = delete;
+    smtp_session(smtp_session &&) = delete;
+    smtp_session & operator=(smtp_session &&) = delete;
+
+    // Start a mail transaction and return the stream for the message body, complete it with finish_mail().
+    [[nodiscard]] std::ostream & start_mail(const std::string & from, const std::string & to, const std::string & subject, const std::string & replyto);
+    void finish_mail();
+
+    // Close the connection if idle for longer than the keepalive time.
+    void idle(std::time_t now);
+
+    // Send QUIT and close the connection.
+    void quit() noexcept;
+
+    [[nodiscard]] bool connected() const noexcept { return m_socket != -1; }
+
+  private:
+    friend class smtp_body_buf;
+
+    const std::string m_host;
+    const std::string m_port;
+    const unsigned m_keepalive;
+
+    int m_socket{ -1 };
+    bool m_pipelining{ false };
+    std::time_t m_last_used{ 0 };
+    std::array<char, 1024> m_rbuf{};
+    std::size_t m_rbuf_used{ 0 };
+
+    smtp_body_buf m_body_buf;
+    std::ostream m_body;
+
+    void connect();
+    void close() noexcept;
+    void write(const char * data, std::size_t len);
+    void write(const std::string & data) { write(data.c_str(), data.length()); }
+    [[nodiscard]] std::string read_line();
+    std::string expect(const std::string & cmd, int code);
+    void send_envelope(const std::string & from, const std::string & to);
+};
+
+// Send a single mail over a new connection.
 void send_mail(const std::string & smtpserver, const std::string & smtpport, const std::string & from, const std::string & to, const std::string & subject,
                const std::string & replyto, const std::string & msg);
 
@@ -0,0 +1,191 @@
+#include "state_file.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>  // std::rename
+#include <fstream>
+#include <sstream>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/set.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "../libs/errnoexception.hpp"
+#include "../libs/libexception.hpp"
+#include "../libs/scopeguard.hpp"
+
+namespace ctguard::research {
+
+static constexpr std::array<char, 8> STATE_MAGIC{ 'C', 'T', 'G', 'R', 'S', 'T', 'A', 'T' };
+static constexpr std::uint32_t STATE_VERSION{ 4 };
+
+std::size_t state_snapshot::update(std::map<rule_id_t, struct rule_state> & rules_state)
+{
+    std::size_t updated{ 0 };
+
+    for (auto & iter : rules_state) {
+        std::multimap<std::time_t, event> mevents;
+        std::time_t unless_triggered;  // NOLINT(cppcoreguidelines-init-variables)
+        short unsigned unless_timeout;  // NOLINT(cppcoreguidelines-init-variables)
+        event unless_event;
+        approx_window approx;
+        distinct_window distinct;
+
+        {
+            std::lock_guard lg{ iter.second.mutex };
+            if (!iter.second.dirty) {
+                continue;
+            }
+            iter.second.dirty = false;
+
+            mevents = iter.second.mevents;
+            unless_triggered = iter.second.unless_triggered;
+            unless_timeout = iter.second.unless_timeout;
+            if (unless_triggered != 0) {
+                unless_event = iter.second.unless_event;
+            }
+            approx = iter.second.approx;
+            distinct = iter.second.distinct;
+        }
+
+        updated++;
+
+        if (mevents.empty() && unless_triggered == 0 && approx.empty() && distinct.empty()) {
+            m_entries.erase(iter.first);
+            continue;
+        }
+
+        std::ostringstream oss;
+        {
+            cereal::BinaryOutputArchive oarchive{ oss };
+            oarchive(iter.first, mevents, unless_triggered, unless_timeout, unless_event, approx, distinct);
+        }
+        m_entries[iter.first] = oss.str();
+    }
+
+    return updated;
+}
+
+[[nodiscard]] static bool write_all(int fd, const char * data, std::size_t size)
+{
+    while (size > 0) {
+        const ssize_t ret = ::write(fd, data, size);
+        if (ret == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += ret;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        size -= static_cast<std::size_t>(ret);
+    }
+    return true;
+}
+
+void state_snapshot::write(const std::string & path) const
+{
+    const std::string path_tmp = path + ".tmp";
+
+    {
+        // holds raw log lines
+        const int fd = ::open(path_tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0600);  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+        if (fd == -1) {
+            throw libs::errno_exception{ "Can not open state file '" + path_tmp + "'" };
+        }
+        libs::scope_guard sg{ [fd]() { ::close(fd); } };
+
+        // an existing temporary file keeps its mode
+        if (::fchmod(fd, 0600) == -1) {
+            throw libs::errno_exception{ "Can not change mode of state file '" + path_tmp + "'" };
+        }
+
+        const std::uint64_t count{ m_entries.size() };
+        std::ostringstream header{ std::ios::out | std::ios::binary };
+        header.write(STATE_MAGIC.data(), STATE_MAGIC.size());
+        {
+            cereal::BinaryOutputArchive oarchive{ header };
+            oarchive(STATE_VERSION, count);
+        }
+
+        const std::string head{ header.str() };
+        bool ok = write_all(fd, head.data(), head.size());
+        for (auto iter = m_entries.cbegin(); ok && iter != m_entries.cend(); ++iter) {
+            ok = write_all(fd, iter->second.data(), iter->second.size());
+        }
+        if (!ok) {
+            throw libs::errno_exception{ "Can not write state file '" + path_tmp + "'" };
+        }
+    }
+
+    if (std::rename(path_tmp.c_str(), path.c_str()) == -1) {
+        throw libs::errno_exception{ "Can not rename '" + path_tmp + "' to '" + path + "'" };
+    }
+}
+
+bool load_state(const std::string & path, std::map<rule_id_t, struct rule_state> & rules_state)
+{
+    std::ifstream state_file{ path, std::ios::in | std::ios::binary };
+    if (!state_file.is_open()) {
+        if (errno == ENOENT) {
+            return false;
+        }
+        throw libs::errno_exception{ "Can not open state file '" + path + "'" };
+    }
+
+    // the state is trusted like the rule files
+    struct ::stat info;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    if (::stat(path.c_str(), &info) == -1) {
+        throw libs::errno_exception{ "Can not stat state file '" + path + "'" };
+    }
+    if (info.st_uid != ::geteuid() || (info.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+        throw libs::lib_exception{ "Insecure state file '" + path + "'" };
+    }
+
+    std::array<char, STATE_MAGIC.size()> magic;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    if (!state_file.read(magic.data(), magic.size()) || magic != STATE_MAGIC) {
+        throw libs::lib_exception{ "Invalid state file header" };
+    }
+
+    cereal::BinaryInputArchive iarchive{ state_file };
+
+    std::uint32_t version;  // NOLINT(cppcoreguidelines-init-variables)
+    std::uint64_t count;    // NOLINT(cppcoreguidelines-init-variables)
+    iarchive(version);
+    if (version != STATE_VERSION) {
+        throw libs::lib_exception{ "Unsupported state file version " + std::to_string(version) };
+    }
+    iarchive(count);
+
+    for (std::uint64_t i = 0; i < count; ++i) {
+        rule_id_t id;  // NOLINT(cppcoreguidelines-init-variables)
+        std::multimap<std::time_t, event> mevents;
+        std::time_t unless_triggered;  // NOLINT(cppcoreguidelines-init-variables)
+        short unsigned unless_timeout;  // NOLINT(cppcoreguidelines-init-variables)
+        event unless_event;
+        approx_window approx;
+        distinct_window distinct;
+        iarchive(id, mevents, unless_triggered, unless_timeout, unless_event, approx, distinct);
+
+        auto & rs = rules_state[id];
+        std::lock_guard lg{ rs.mutex };
+        rs.mevents = std::move(mevents);
+        rs.unless_triggered = unless_triggered;
+        rs.unless_timeout = unless_timeout;
+        rs.unless_event = std::move(unless_event);
+        rs.approx = std::move(approx);
+        rs.distinct = std::move(distinct);
+        rs.dirty = true;
+    }
+
+    return true;
+}
+
+} /* namespace ctguard::research */
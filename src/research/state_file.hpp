@@ -0,0 +1,30 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "research.hpp"
+
+namespace ctguard::research {
+
+// Incremental snapshot of the correlation state.
+// Only entries modified since the last update are copied (under their own lock) and re-serialized,
+// so the processing task is never blocked for more than a single entry.
+class state_snapshot
+{
+  public:
+    // Returns the number of re-serialized entries.
+    std::size_t update(std::map<rule_id_t, struct rule_state> & rules_state);
+
+    // Atomically replace the state file at path with the current snapshot; throws on error.
+    void write(const std::string & path) const;
+
+  private:
+    std::map<rule_id_t, std::string> m_entries;
+};
+
+// Restore a state file written by state_snapshot::write(); throws on error.
+// Returns false if the file does not exist.
+[[nodiscard]] bool load_state(const std::string & path, std::map<rule_id_t, struct rule_state> & rules_state);
+
+} /* namespace ctguard::research */
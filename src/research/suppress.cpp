@@ -0,0 +1,83 @@
+#include "suppress.hpp"
+
+namespace ctguard::research {
+
+bool alert_suppressor::check(const event & e, const struct suppress_rule & sr, std::time_t now)
+{
+    std::string key;
+    if (!sr.field.empty()) {
+        const auto field = e.fields().find(sr.field);
+        if (field == e.fields().end()) {
+            // can not identify repeats
+            return true;
+        }
+        key = field->second;
+    }
+
+    std::lock_guard lg{ m_mutex };
+
+    auto iter = m_entries.find(key_t{ e.rule_id(), key });
+    if (iter != m_entries.end() && iter->second.expires > now) {
+        iter->second.repeats++;
+        iter->second.last = e;
+        return false;
+    }
+    if (iter != m_entries.end()) {
+        close(iter, m_evicted);
+    }
+
+    if (m_entries.size() >= m_max_entries && !m_expiry.empty()) {
+        close(m_entries.find(m_expiry.begin()->second), m_evicted);
+    }
+
+    const std::time_t expires{ now + sr.time };
+    key_t k{ e.rule_id(), std::move(key) };
+    m_expiry.emplace(expires, k);
+    m_entries.emplace(std::move(k), entry{ expires, 0, event{} });
+
+    return true;
+}
+
+std::vector<event> alert_suppressor::expire(std::time_t now)
+{
+    std::lock_guard lg{ m_mutex };
+
+    std::vector<event> summaries{ std::move(m_evicted) };
+    m_evicted.clear();
+
+    while (!m_expiry.empty() && m_expiry.begin()->first <= now) {
+        close(m_entries.find(m_expiry.begin()->second), summaries);
+    }
+
+    return summaries;
+}
+
+std::vector<event> alert_suppressor::flush()
+{
+    std::lock_guard lg{ m_mutex };
+
+    std::vector<event> summaries{ std::move(m_evicted) };
+    m_evicted.clear();
+
+    while (!m_entries.empty()) {
+        close(m_entries.begin(), summaries);
+    }
+
+    return summaries;
+}
+
+void alert_suppressor::close(std::map<key_t, entry>::iterator iter, std::vector<event> & summaries)
+{
+    if (iter->second.repeats > 0) {
+        event & summary = iter->second.last;
+        summary.traits()["suppressed_repeats"] = std::to_string(iter->second.repeats);
+        // interventions were already triggered by the first alert of the window
+        summary.interventions({});
+        summaries.emplace_back(std::move(summary));
+    }
+
+    m_expiry.erase(std::make_pair(iter->second.expires, iter->first));
+    m_entries.erase(iter);
+}
+
+} /* namespace ctguard::research */
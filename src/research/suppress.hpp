@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "event.hpp"
+#include "rule.hpp"
+
+namespace ctguard::research {
+
+// Collapses repeated alerts of a rule with the same key field into one alert per suppression window.
+// The first alert of a window is forwarded, repeats are counted and reported by one summary alert,
+// carrying the trait 'suppressed_repeats', when the window expires.
+// The number of tracked windows is bounded; if full, the window expiring next is closed early.
+class alert_suppressor
+{
+  public:
+    explicit alert_suppressor(std::size_t max_entries) : m_max_entries{ max_entries } {}
+
+    // Returns false if the event is a repeat within an active window and should be dropped.
+    [[nodiscard]] bool check(const event & e, const struct suppress_rule & sr, std::time_t now);
+
+    // Close all windows expired at now; returns the summary alerts of windows with repeats.
+    [[nodiscard]] std::vector<event> expire(std::time_t now);
+
+    // Close all windows.
+    [[nodiscard]] std::vector<event> flush();
+
+  private:
+    using key_t = std::pair<rule_id_t, std::string>;
+    struct entry
+    {
+        std::time_t expires;
+        unsigned long repeats;  // NOLINT(google-runtime-int)
+        event last;
+    };
+
+    std::mutex m_mutex;
+    const std::size_t m_max_entries;
+    std::map<key_t, entry> m_entries;
+    std::set<std::pair<std::time_t, key_t>> m_expiry;
+    std::vector<event> m_evicted;
+
+    void close(std::map<key_t, entry>::iterator iter, std::vector<event> & summaries);
+};
+
+} /* namespace ctguard::research */
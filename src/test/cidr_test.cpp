@@ -0,0 +1,61 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../research/cidr_set.hpp"
+
+using ctguard::research::cidr_set;
+
+static bool check(const cidr_set & set, const char * address, bool expected)
+{
+    const bool got = set.contains(address);
+    std::cout << address << ": " << std::boolalpha << got << (got == expected ? "" : " FAILED") << "\n";
+    return got == expected;
+}
+
+int main(int, char **)  // NOLINT(readability-named-parameter)
+{
+    bool ok{ true };
+
+    cidr_set set;
+    for (const char * prefix : { "10.0.0.0/8", "192.168.1.0/24", "192.168.1.128/25", "172.16.5.4", "2001:db8::/32", "fe80::/10", "0.0.0.0/32" }) {
+        set.add(prefix);
+    }
+
+    ok &= check(set, "10.1.2.3", true);
+    ok &= check(set, "11.1.2.3", false);
+    ok &= check(set, "192.168.1.1", true);
+    ok &= check(set, "192.168.1.200", true);
+    ok &= check(set, "192.168.2.1", false);
+    ok &= check(set, "172.16.5.4", true);
+    ok &= check(set, "172.16.5.5", false);
+    ok &= check(set, "0.0.0.0", true);
+    ok &= check(set, "0.0.0.1", false);
+    ok &= check(set, "2001:db8:1::1", true);
+    ok &= check(set, "2001:db9::1", false);
+    ok &= check(set, "fe80::1", true);
+    ok &= check(set, "::ffff:10.9.9.9", true);
+    ok &= check(set, "::1", false);
+    ok &= check(set, "not an address", false);
+    ok &= check(set, "", false);
+
+    // the whole address space
+    cidr_set all;
+    all.add("::/0");
+    ok &= check(all, "8.8.8.8", true);
+    ok &= check(all, "2001:db8::1", true);
+
+    for (const char * invalid : { "10.0.0.0/33", "10.0.0/8", "2001:db8::/129", "10.0.0.0/x" }) {
+        try {
+            cidr_set s;
+            s.add(invalid);
+            std::cout << invalid << ": accepted FAILED\n";
+            ok = false;
+        } catch (const std::exception & e) {
+            std::cout << invalid << ": rejected (" << e.what() << ")\n";
+        }
+    }
+
+    std::cout << (ok ? "SUCCESS!" : "FAILURE!") << "\n";
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,63 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../research/distinct_window.hpp"
+
+using ctguard::research::distinct_counter;
+using ctguard::research::distinct_window;
+
+static bool check(const char * what, std::uint64_t got, std::uint64_t expected, double tolerance)
+{
+    const double error = std::fabs(static_cast<double>(got) - static_cast<double>(expected)) / static_cast<double>(expected);
+    std::cout << what << ": " << got << " (expected " << expected << ", error " << error * 100 << "%)\n";
+    return error <= tolerance;
+}
+
+int main(int, char **)  // NOLINT(readability-named-parameter)
+{
+    bool ok{ true };
+
+    // exact below the limit, duplicates ignored
+    {
+        distinct_window dw;
+        dw.configure(300, 256 * 1024);
+        for (int i = 0; i < 3; ++i) {
+            for (std::size_t u = 0; u < distinct_counter::EXACT_LIMIT; ++u) {
+                (void)dw.add("10.0.0.1", "user" + std::to_string(u), 1000 + i);
+            }
+        }
+        (void)dw.add("10.0.0.2", "root", 1000);
+        ok &= check("exact", dw.count("10.0.0.1", 1002), distinct_counter::EXACT_LIMIT, 0.0);
+        ok &= check("other key", dw.count("10.0.0.2", 1002), 1, 0.0);
+        ok &= check("expired", dw.count("10.0.0.1", 2000) + 1, 1, 0.0);
+        dw.reset("10.0.0.2");
+        ok &= check("reset", dw.count("10.0.0.2", 1002) + 1, 1, 0.0);
+    }
+
+    // HyperLogLog beyond the limit, merged over buckets
+    for (const std::uint64_t n : { std::uint64_t{ 1000 }, std::uint64_t{ 20000 }, std::uint64_t{ 500000 } }) {
+        distinct_window dw;
+        dw.configure(300, 256 * 1024);
+        for (std::uint64_t u = 0; u < n; ++u) {
+            (void)dw.add("key", "user" + std::to_string(u), static_cast<std::time_t>(1000 + u * 200 / n));
+        }
+        ok &= check(("hll " + std::to_string(n)).c_str(), dw.count("key", 1200), n, 0.1);
+    }
+
+    // memory cap evicts the least recently seen keys
+    {
+        distinct_window dw;
+        dw.configure(300, 16 * 1024);
+        bool capped{ false };
+        for (int k = 0; k < 1000; ++k) {
+            capped |= dw.add("10.1.0." + std::to_string(k), "root", 1000);
+        }
+        std::cout << "capped: " << capped << ", memory: " << dw.memory_usage() << ", evictions: " << dw.cap_hits() << "\n";
+        ok &= capped && dw.memory_usage() <= 16 * 1024 && dw.count("10.1.0.999", 1000) == 1 && dw.count("10.1.0.0", 1000) == 0;
+    }
+
+    std::cout << (ok ? "SUCCESS!" : "FAILURE!") << "\n";
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,192 @@
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Minimal SMTP server for the itests: accepts one client at a time on an ephemeral local port,
+// written to port_file, and records the received commands and mail bodies in transcript_file.
+// With --pipelining the extension is offered and the replies to MAIL and RCPT are held back until
+// DATA is received, so a client waiting for each reply stalls.
+
+namespace {
+
+class connection
+{
+  public:
+    explicit connection(int fd) : m_fd{ fd } {}
+    ~connection() { ::close(m_fd); }
+
+    connection(const connection &) = delete;
+    connection & operator=(const connection &) = delete;
+    connection(connection &&) = delete;
+    connection & operator=(connection &&) = delete;
+
+    // Next line without the line ending, false on end of connection.
+    bool read_line(std::string & line)
+    {
+        for (;;) {
+            if (const auto pos = m_buffer.find("\r\n"); pos != std::string::npos) {
+                line = m_buffer.substr(0, pos);
+                m_buffer.erase(0, pos + 2);
+                return true;
+            }
+
+            char buf[1024];  // NOLINT(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+            const ssize_t ret = ::recv(m_fd, buf, sizeof buf, 0);  // NOLINT(cppcoreguidelines-pro-bounds-array-to-pointer-decay,hicpp-no-array-decay)
+            if (ret == -1 && errno == EINTR) {
+                continue;
+            }
+            if (ret <= 0) {
+                return false;
+            }
+            m_buffer.append(buf, static_cast<std::size_t>(ret));  // NOLINT(cppcoreguidelines-pro-bounds-array-to-pointer-decay,hicpp-no-array-decay)
+        }
+    }
+
+    void reply(const std::string & msg)
+    {
+        const std::string data{ msg + "\r\n" };
+        if (::send(m_fd, data.c_str(), data.length(), MSG_NOSIGNAL) == -1) {
+            std::cerr << "Can not send reply: " << ::strerror(errno) << "\n";
+        }
+    }
+
+  private:
+    const int m_fd;
+    std::string m_buffer;
+};
+
+void serve(connection & conn, std::ofstream & transcript, bool pipelining)
+{
+    std::vector<std::string> held;
+
+    conn.reply("220 localhost fake ESMTP");
+
+    std::string line;
+    while (conn.read_line(line)) {
+        const std::string cmd{ line.substr(0, 4) };
+
+        if (cmd == "EHLO") {
+            transcript << "> EHLO *" << std::endl;
+            if (pipelining) {
+                conn.reply("250-localhost");
+                conn.reply("250-SIZE 10240000");
+                conn.reply("250 PIPELINING");
+            } else {
+                conn.reply("250-localhost");
+                conn.reply("250 SIZE 10240000");
+            }
+            continue;
+        }
+
+        transcript << "> " << line << std::endl;
+
+        if (cmd == "MAIL" || cmd == "RCPT") {
+            if (pipelining) {
+                held.emplace_back("250 OK");
+            } else {
+                conn.reply("250 OK");
+            }
+        } else if (cmd == "DATA") {
+            for (const auto & h : held) {
+                conn.reply(h);
+            }
+            held.clear();
+            conn.reply("354 End data with <CR><LF>.<CR><LF>");
+
+            bool complete{ false };
+            while (conn.read_line(line)) {
+                if (line == ".") {
+                    complete = true;
+                    break;
+                }
+                // undo dot-stuffing
+                transcript << "| " << (line.compare(0, 1, ".") == 0 ? line.substr(1) : line) << std::endl;
+            }
+            if (!complete) {
+                break;
+            }
+            transcript << "> ." << std::endl;
+            conn.reply("250 OK queued");
+        } else if (cmd == "QUIT") {
+            conn.reply("221 Bye");
+            break;
+        } else {
+            conn.reply("502 Command not implemented");
+        }
+    }
+}
+
+} /* namespace */
+
+int main(int argc, char ** argv)
+{
+    const std::vector<std::string> args{ argv + 1, argv + argc };  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    bool pipelining{ false };
+    std::vector<std::string> files;
+    for (const auto & arg : args) {
+        if (arg == "--pipelining") {
+            pipelining = true;
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.size() != 2) {
+        std::cerr << "Usage: " << argv[0] << " [--pipelining] port_file transcript_file\n";  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return EXIT_FAILURE;
+    }
+
+    const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == -1) {
+        std::cerr << "Can not create socket: " << ::strerror(errno) << "\n";
+        return EXIT_FAILURE;
+    }
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addr_len = sizeof addr;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (::bind(listener, reinterpret_cast<struct sockaddr *>(&addr), sizeof addr) == -1 || ::listen(listener, 4) == -1 ||
+        ::getsockname(listener, reinterpret_cast<struct sockaddr *>(&addr), &addr_len) == -1) {  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        std::cerr << "Can not listen: " << ::strerror(errno) << "\n";
+        return EXIT_FAILURE;
+    }
+
+    std::ofstream transcript{ files[1] };
+    if (!transcript.is_open()) {
+        std::cerr << "Can not open '" << files[1] << "': " << ::strerror(errno) << "\n";
+        return EXIT_FAILURE;
+    }
+
+    {
+        std::ofstream port_file{ files[0] };
+        port_file << ntohs(addr.sin_port) << "\n";
+    }
+
+    for (unsigned n = 1;; ++n) {
+        const int fd = ::accept(listener, nullptr, nullptr);
+        if (fd == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Can not accept: " << ::strerror(errno) << "\n";
+            return EXIT_FAILURE;
+        }
+
+        transcript << "connection " << n << std::endl;
+        {
+            connection conn{ fd };
+            serve(conn, transcript, pipelining);
+        }
+        transcript << "connection " << n << " closed" << std::endl;
+    }
+}
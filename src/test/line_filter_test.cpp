@@ -0,0 +1,34 @@
+#include <cstdlib>
+#include <iostream>
+
+#include "../logscan/line_filter.hpp"
+#include "test_check.h"
+
+using ctguard::logscan::line_filter;
+using ctguard::logscan::line_filter_config;
+
+int main(int, char **)  // NOLINT(readability-named-parameter)
+{
+    bool ok{ true };
+
+    line_filter_config cfg;
+    cfg.drop = { "pam_unix(cron:session)" };
+    cfg.drop_regex = { "^CRON\\[\\d+\\]: " };
+    cfg.keep = { "root" };
+    line_filter lf{ cfg };
+
+    ok &= check("other passed", lf.pass("sshd[42]: Accepted publickey for alice"));
+    ok &= check("literal dropped", !lf.pass("pam_unix(cron:session): session opened for user www-data"));
+    ok &= check("regex dropped", !lf.pass("CRON[1234]: (www-data) CMD (php /srv/cron.php)"));
+    ok &= check("regex anchored", lf.pass("sshd: CRON[1234]: "));
+    ok &= check("keep wins", lf.pass("CRON[1234]: (root) CMD (run-parts /etc/cron.hourly)"));
+    ok &= check("dropped counted", lf.dropped() == 2);
+    ok &= check("report changed", lf.take_changed() && !lf.take_changed());
+    ok &= check("report changed again", !lf.pass("CRON[1]: x") && lf.take_changed());
+
+    line_filter_config keep_only;
+    keep_only.keep_regex = { "." };
+    ok &= check("keep alone passes", keep_only.empty() && line_filter{ keep_only }.pass("anything"));
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,64 @@
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../logscan/line_reader.hpp"
+#include "test_check.h"
+
+using ctguard::logscan::line_reader;
+
+int main(int, char **)  // NOLINT(readability-named-parameter)
+{
+    bool ok{ true };
+
+    std::FILE * f = open_temp_file();
+    const int fd = ::fileno(f);
+
+    line_reader reader;
+    std::vector<std::string> lines;
+    const auto collect = [&lines](std::string_view line) { lines.emplace_back(line); };
+
+    append(f, "first\n\nsecond\npart");
+    off_t pos = reader.read(fd, 0, collect);
+    ok &= check("complete lines", lines == std::vector<std::string>{ "first", "second" });
+    ok &= check("partial line left", pos == 14);
+
+    lines.clear();
+    pos = reader.read(fd, pos, collect);
+    ok &= check("partial line not passed on", lines.empty() && pos == 14);
+
+    append(f, "ial\nthird\n");
+    pos = reader.read(fd, pos, collect);
+    ok &= check("partial line completed", lines == std::vector<std::string>{ "partial", "third" });
+    ok &= check("position at end", pos == 28);
+
+    lines.clear();
+    const std::string long_line(line_reader::CHUNK_SIZE + 10, 'x');
+    append(f, long_line + "\nlast\n");
+    pos = reader.read(fd, pos, collect);
+    ok &= check("long line split", lines.size() == 3 && lines[0].size() == line_reader::CHUNK_SIZE && lines[1].size() == 10 && lines[2] == "last");
+    ok &= check("position after long line", pos == static_cast<off_t>(28 + long_line.size() + 6));
+
+    lines.clear();
+    append(f, "rotated\ntrailing");
+    pos = reader.drain(fd, pos, collect);
+    ok &= check("drain passes partial line", lines == std::vector<std::string>{ "rotated", "trailing" });
+    ok &= check("position after drain", pos == static_cast<off_t>(28 + long_line.size() + 6 + 16));
+
+    const auto fp = line_reader::fingerprint(fd, 5);
+    ok &= check("fingerprint of start", fp.has_value() && fp == line_reader::fingerprint(fd, 5) && fp != line_reader::fingerprint(fd, 6));
+
+    std::fclose(f);
+
+    f = open_temp_file();
+    append(f, "first");
+    ok &= check("fingerprint of content", fp == line_reader::fingerprint(::fileno(f), 5));
+    ok &= check("fingerprint of short file", !line_reader::fingerprint(::fileno(f), 6).has_value());
+    std::fclose(f);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,58 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../research/load_shedder.hpp"
+
+using ctguard::research::load_shedder;
+
+static ctguard::libs::source_event make_event(const char * domain, bool control = false)
+{
+    ctguard::libs::source_event se;
+    se.source_domain = domain;
+    se.control_message = control;
+    se.message = "test";
+    return se;
+}
+
+static bool check(const char * what, bool got, bool expected)
+{
+    std::cout << what << ": " << std::boolalpha << got << (got == expected ? "" : " FAILED") << "\n";
+    return got == expected;
+}
+
+int main(int, char **)  // NOLINT(readability-named-parameter)
+{
+    bool ok{ true };
+
+    load_shedder shedder{ 100, 4, { "debug" } };
+
+    ok &= check("below high water", shedder.admit(make_event("syslog"), 99), true);
+    ok &= check("shed domain below high water", shedder.admit(make_event("debug"), 99), true);
+    ok &= check("no report before shedding", shedder.report(99, 1000).has_value(), false);
+
+    unsigned kept{ 0 };
+    for (int i = 0; i < 40; ++i) {
+        kept += shedder.admit(make_event("syslog"), 100) ? 1U : 0U;
+    }
+    ok &= check("sampled 1 in 4", kept == 10, true);
+    ok &= check("shed domain dropped", shedder.admit(make_event("debug"), 100), false);
+    ok &= check("hard limit", shedder.admit(make_event("syslog"), 200), false);
+    ok &= check("control kept", shedder.admit(make_event("daemon", true), 1000), true);
+    ok &= check("no report within interval", shedder.report(100, 1000).has_value(), false);
+
+    // hysteresis: still shedding above half the high water mark
+    ok &= check("no report above half high water", shedder.report(60, 1001).has_value(), false);
+    ok &= check("still shedding", shedder.shedding(), true);
+
+    const auto report = shedder.report(10, 1002);
+    ok &= check("report after shedding stopped", report.has_value(), true);
+    if (report) {
+        std::cout << report->message << "\n";
+        ok &= check("report content", report->control_message && report->message == "Load shedding: dropped 32 events (debug: 1, syslog: 31)", true);
+    }
+    ok &= check("admitted after shedding stopped", shedder.admit(make_event("debug"), 10), true);
+    ok &= check("total", shedder.total_shed() == 32, true);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,78 @@
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../logscan/line_reader.hpp"
+
+using ctguard::logscan::line_reader;
+
+// Line throughput of reading a log file with std::getline and with the chunked line reader.
+int main(int argc, char ** argv)
+{
+    if (argc != 2 && argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " log_file [iterations]\n";  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return EXIT_FAILURE;
+    }
+    const char * path = argv[1];                                              // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    const unsigned long iterations = argc == 3 ? std::stoul(argv[2]) : 1;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic,google-runtime-int)
+
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    struct stat st;                                    // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    if (fd == -1 || ::fstat(fd, &st) == -1) {
+        std::cerr << "Can not open '" << path << "': " << ::strerror(errno) << "\n";
+        return EXIT_FAILURE;
+    }
+
+    const auto report = [&st, iterations](const char * name, unsigned long long lines, std::chrono::steady_clock::duration d) {  // NOLINT(google-runtime-int)
+        const double seconds = std::chrono::duration<double>(d).count();
+        std::cout << name << ": " << lines << " lines in " << seconds << "s, " << (static_cast<double>(lines) / seconds) << " lines/s, "
+                  << (static_cast<double>(st.st_size) * static_cast<double>(iterations) / seconds / 1024.0 / 1024.0) << " MiB/s\n";
+    };
+
+    try {
+        unsigned long long lines{ 0 };  // NOLINT(google-runtime-int)
+        std::size_t bytes{ 0 };
+
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < iterations; ++i) {  // NOLINT(google-runtime-int)
+            std::ifstream input{ path };
+            input.seekg(0);
+            std::string line;
+            while (std::getline(input, line)) {
+                if (!line.empty()) {
+                    lines++;
+                    bytes += line.size();
+                }
+            }
+        }
+        report("std::getline", lines, std::chrono::steady_clock::now() - start);
+
+        lines = 0;
+        start = std::chrono::steady_clock::now();
+        line_reader reader;
+        line_reader::advise_sequential(fd);
+        for (unsigned long i = 0; i < iterations; ++i) {  // NOLINT(google-runtime-int)
+            reader.read(fd, 0, [&lines, &bytes](std::string_view line) {
+                lines++;
+                bytes += line.size();
+            });
+        }
+        report("line_reader", lines, std::chrono::steady_clock::now() - start);
+
+        std::cout << "(" << bytes << " bytes in lines)\n";
+
+    } catch (const std::exception & e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    ::close(fd);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,50 @@
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "../logscan/multiline.hpp"
+#include "test_check.h"
+
+using ctguard::logscan::multiline_assembler;
+using ctguard::logscan::multiline_config;
+
+int main(int, char **)  // NOLINT(readability-named-parameter)
+{
+    bool ok{ true };
+
+    multiline_config start;
+    start.mode = multiline_config::mode_t::START;
+    start.start = "^\\d{4}-\\d{2}-\\d{2} ";
+    multiline_assembler sa{ start };
+
+    ok &= check("nothing pending", !sa.flush().has_value() && !sa.deadline().has_value());
+    ok &= check("first line kept", !sa.push("2021-01-01 ERROR java.lang.NullPointerException").has_value() && sa.deadline().has_value());
+    ok &= check("continuation kept", !sa.push("\tat Foo.bar(Foo.java:42)").has_value() && !sa.push("Caused by: x").has_value());
+    auto record = sa.push("2021-01-01 INFO next");
+    ok &= check("record on next start",
+                record.has_value() && *record == "2021-01-01 ERROR java.lang.NullPointerException\n\tat Foo.bar(Foo.java:42)\nCaused by: x");
+    record = sa.flush();
+    ok &= check("flush pending", record.has_value() && *record == "2021-01-01 INFO next" && !sa.deadline().has_value());
+
+    ok &= check("leading continuation starts a record", !sa.push("orphan").has_value() && sa.flush() == std::optional<std::string>{ "orphan" });
+
+    multiline_config indent;
+    indent.mode = multiline_config::mode_t::INDENT;
+    multiline_assembler ia{ indent };
+
+    ok &= check("indent first line", !ia.push("Traceback (most recent call last):").has_value());
+    ok &= check("indent continuation", !ia.push("  File \"x.py\", line 1").has_value());
+    record = ia.push("ValueError: y");
+    ok &= check("indent record", record.has_value() && *record == "Traceback (most recent call last):\n  File \"x.py\", line 1");
+
+    std::size_t records{ 0 };
+    for (std::size_t i = 0; i < multiline_assembler::MAX_LINES + 1; ++i) {
+        if (ia.push(" more").has_value()) {
+            records++;
+        }
+    }
+    ok &= check("record size limited", records == 1);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
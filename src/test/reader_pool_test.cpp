@@ -0,0 +1,57 @@
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "../logscan/reader_pool.hpp"
+#include "test_check.h"
+
+using ctguard::logscan::reader_pool;
+
+int main(int, char **)  // NOLINT(readability-named-parameter)
+{
+    bool ok{ true };
+
+    reader_pool pool{ 4 };
+    ok &= check("pool size", pool.size() == 4);
+
+    for (int round = 0; round < 100; ++round) {
+        std::vector<std::atomic<unsigned>> runs(1000);
+        pool.run(runs.size(), [&runs](std::size_t job, unsigned) { runs[job]++; });
+
+        bool once{ true };
+        for (const auto & r : runs) {
+            once &= r == 1;
+        }
+        if (!once) {
+            ok &= check("every job runs once", false);
+            break;
+        }
+    }
+    ok &= check("every job runs once", true);
+
+    bool thrown{ false };
+    try {
+        pool.run(100, [](std::size_t job, unsigned) {
+            if (job == 42) {
+                throw std::runtime_error{ "job failed" };
+            }
+        });
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    ok &= check("job exception rethrown", thrown);
+
+    std::atomic<unsigned> count{ 0 };
+    pool.run(10, [&count](std::size_t, unsigned) { count++; });
+    ok &= check("usable after exception", count == 10);
+
+    reader_pool single{ 1 };
+    unsigned sequence{ 0 };
+    bool ordered{ true };
+    single.run(10, [&sequence, &ordered](std::size_t job, unsigned worker) { ordered &= job == sequence++ && worker == 0; });
+    ok &= check("single worker runs in order", ordered && sequence == 10);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
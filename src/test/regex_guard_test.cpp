@@ -0,0 +1,36 @@
+#include <cstdlib>
+#include <iostream>
+#include <regex>
+#include <string>
+
+#include "../research/regex_guard.hpp"
+#include "test_check.h"
+
+using ctguard::research::regex_guard;
+
+int main(int, char **)  // NOLINT(readability-named-parameter)
+{
+    bool ok{ true };
+
+    regex_guard guard{ 8, std::chrono::milliseconds{ 100 }, std::chrono::milliseconds{ 100 } };
+    const std::regex anchored{ "user \\w+$" };
+    const std::regex prefix{ "^user" };
+    const std::regex format{ "(\\w+) (\\w+)" };
+    std::smatch match;
+    ctguard::libs::format_match fmatch;
+
+    guard.start_event();
+    ok &= check("short anchored", guard.search("user bob", match, anchored, 1));
+    ok &= check("short not truncated", !guard.truncated());
+
+    guard.start_event();
+    ok &= check("cut end is no end of line", !guard.search("user bobby-tables", match, anchored, 1));
+    ok &= check("truncated", guard.truncated());
+    ok &= check("cut prefix", guard.search("user bobby-tables", match, prefix, 2));
+    ok &= check("cut format match", guard.match("user bobby-tables", fmatch, format, "f") && fmatch[2] == "bob");
+
+    guard.start_event();
+    ok &= check("truncation reset", !guard.truncated());
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
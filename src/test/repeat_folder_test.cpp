@@ -0,0 +1,47 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "../logscan/repeat_folder.hpp"
+#include "test_check.h"
+
+using ctguard::logscan::repeat_folder;
+
+int main(int, char **)  // NOLINT(readability-named-parameter)
+{
+    bool ok{ true };
+
+    const auto t0 = repeat_folder::clock::now();
+    const std::chrono::seconds window{ 10 };
+    repeat_folder rf{ window };
+
+    ok &= check("nothing due", !rf.deadline().has_value() && rf.expire(t0).empty());
+    ok &= check("first passed", rf.pass("sshd: connection closed", t0));
+    ok &= check("single line not due", !rf.deadline().has_value());
+    ok &= check("repeat folded", !rf.pass("sshd: connection closed", t0 + std::chrono::seconds{ 1 }) &&
+                                     !rf.pass("sshd: connection closed", t0 + std::chrono::seconds{ 2 }));
+    ok &= check("other passed", rf.pass("sshd: connection opened", t0 + std::chrono::seconds{ 3 }));
+    ok &= check("summary due at end of window", rf.deadline() == t0 + window);
+    ok &= check("not expired early", rf.expire(t0 + std::chrono::seconds{ 5 }).empty());
+
+    auto done = rf.expire(t0 + window);
+    ok &= check("summary", done.size() == 1 && done[0].first == "sshd: connection closed" && done[0].second == 2);
+    ok &= check("passed after window", rf.pass("sshd: connection closed", t0 + window + std::chrono::seconds{ 1 }));
+
+    repeat_folder late{ window };
+    ok &= check("late first", late.pass("x", t0) && !late.pass("x", t0 + std::chrono::seconds{ 1 }));
+    ok &= check("late new window", late.pass("x", t0 + window + std::chrono::seconds{ 1 }));
+    done = late.expire(t0 + window + std::chrono::seconds{ 2 });
+    ok &= check("late summary", done.size() == 1 && done[0].second == 1);
+
+    repeat_folder full{ window };
+    ok &= check("evicted first", full.pass("first", t0) && !full.pass("first", t0));
+    for (std::size_t i = 0; i < repeat_folder::WINDOW_SIZE; ++i) {
+        ok &= full.pass(std::to_string(i), t0 + std::chrono::seconds{ 1 });
+    }
+    ok &= check("evicted summary due", full.deadline() == repeat_folder::clock::time_point::min());
+    done = full.expire(t0 + std::chrono::seconds{ 1 });
+    ok &= check("evicted summary", done.size() == 1 && done[0].first == "first" && done[0].second == 1);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
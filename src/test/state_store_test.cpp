@@ -0,0 +1,91 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../logscan/state_store.hpp"
+#include "test_check.h"
+
+using ctguard::logscan::state_store;
+
+static off_t file_size(const std::string & path)
+{
+    struct stat st;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    return ::stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+int main(int, char **)  // NOLINT(readability-named-parameter)
+{
+    bool ok{ true };
+
+    const std::string path{ make_temp_file("state_store_test") };
+
+    {
+        state_store store{ path };
+        ok &= check("empty file is a clean start", !store.find("/var/log/a").has_value());
+        store.update("/var/log/a", { 1, 100, 42, 10 });
+        store.update("/var/log/b", { 2, 200, 0, 0 });
+        store.flush();
+    }
+    ok &= check("header and two records", file_size(path) == 3 * 64);
+
+    {
+        state_store store{ path };
+        const auto a = store.find("/var/log/a");
+        ok &= check("entry found", a.has_value() && a->inode == 1 && a->position == 100 && a->fingerprint == 42 && a->fingerprint_length == 10);
+        ok &= check("unknown entry", !store.find("/var/log/c").has_value());
+
+        store.update("/var/log/b", { 2, 300, 0, 0 });
+        store.update("/var/log/c", { 3, 10, 0, 0 });
+        store.flush();
+        ok &= check("updated in place", file_size(path) == 4 * 64);
+
+        store.remove("/var/log/a");
+        store.update("/var/log/d", { 4, 20, 0, 0 });
+        store.flush();
+        ok &= check("free slot reused", file_size(path) == 4 * 64);
+    }
+
+    {
+        state_store store{ path };
+        const auto b = store.find("/var/log/b");
+        ok &= check("updated entry", b.has_value() && b->position == 300);
+        ok &= check("removed entry", !store.find("/var/log/a").has_value());
+        ok &= check("added entry", store.find("/var/log/d").has_value() && store.find("/var/log/c").has_value());
+
+        store.retain({ "/var/log/b", "/var/log/d" });
+        store.flush();
+        ok &= check("compacted", file_size(path) == 3 * 64);
+    }
+
+    {
+        // corrupt the position of the first record
+        std::fstream f{ path, std::ios::in | std::ios::out | std::ios::binary };
+        f.seekp(64 + 16);
+        f.put('\x7f');
+    }
+    {
+        state_store store{ path };
+        ok &= check("corrupted record dropped", store.find("/var/log/b").has_value() != store.find("/var/log/d").has_value());
+    }
+
+    {
+        std::ofstream f{ path, std::ios::trunc };
+        f << "\"/var/log/a\",5,500\n\"/var/log/b\",6,600\n";
+    }
+    {
+        state_store store{ path };
+        const auto a = store.find("/var/log/a");
+        ok &= check("text format read", a.has_value() && a->inode == 5 && a->position == 500 && store.find("/var/log/b").has_value());
+        store.flush();
+        ok &= check("text format converted", file_size(path) == 3 * 64);
+    }
+
+    std::remove(path.c_str());
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,62 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../logscan/systemd_receiver.hpp"
+#include "test_check.h"
+
+using ctguard::logscan::systemd_receiver;
+
+int main(int, char **)  // NOLINT(readability-named-parameter)
+{
+    bool ok{ true };
+
+    std::array<int, 2> fds;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    if (::socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds.data()) == -1) {
+        std::cerr << "Can not create socket pair\n";
+        return EXIT_FAILURE;
+    }
+    const int enable{ 1 };
+    ::setsockopt(fds[0], SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof enable);
+    const int size{ 1024 * 1024 };
+    ::setsockopt(fds[1], SOL_SOCKET, SO_SNDBUF, &size, sizeof size);
+
+    systemd_receiver receiver;
+    std::vector<std::string> messages;
+    const auto collect = [&messages](std::string_view message) { messages.emplace_back(message); };
+
+    ok &= check("nothing pending", receiver.receive(fds[0], 100, collect) == 0 && messages.empty());
+
+    const std::string large(20000, 'x');
+    const std::string huge(systemd_receiver::MESSAGE_SIZE + 10, 'y');
+    for (const std::string & m : { std::string{ "<13>hello" }, large, huge }) {
+        if (::send(fds[1], m.data(), m.size(), 0) != static_cast<ssize_t>(m.size())) {
+            std::cerr << "Can not send message of size " << m.size() << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    ok &= check("all received", receiver.receive(fds[0], 100, collect) == 3 && messages.size() == 3);
+    ok &= check("short message", messages.size() == 3 && messages[0] == "<13>hello");
+    ok &= check("large message not truncated", messages.size() == 3 && messages[1] == large);
+    ok &= check("huge message truncated", messages.size() == 3 && messages[2].size() == systemd_receiver::MESSAGE_SIZE && receiver.truncated() == 1);
+
+    messages.clear();
+    for (int i = 0; i < 40; ++i) {
+        const std::string m{ "message " + std::to_string(i) };
+        ::send(fds[1], m.data(), m.size(), 0);
+    }
+    ok &= check("limited batch", receiver.receive(fds[0], 20, collect) == 20 && messages.size() == 20);
+    ok &= check("rest", receiver.receive(fds[0], 100, collect) == 20 && messages.size() == 40);
+    ok &= check("in order", messages.size() == 40 && messages[0] == "message 0" && messages[39] == "message 39");
+    ok &= check("counted", receiver.received() == 43 && receiver.dropped() == 0);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
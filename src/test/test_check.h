@@ -0,0 +1,48 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Helpers of the plain test programs, which report every check and fail at the end if any check failed.
+
+// Report a check; returns ok, to be and-ed into the result.
+inline bool check(const char * what, bool ok)
+{
+    std::cout << what << (ok ? "" : " FAILED") << "\n";
+    return ok;
+}
+
+// Anonymous temporary file, removed on close; exits on error.
+inline std::FILE * open_temp_file()
+{
+    std::FILE * f = std::tmpfile();
+    if (f == nullptr) {
+        std::cerr << "Can not create temporary file\n";
+        std::exit(EXIT_FAILURE);
+    }
+    return f;
+}
+
+// Create an empty temporary file and return its path; exits on error.
+inline std::string make_temp_file(const std::string & name)
+{
+    std::string path{ "/tmp/" + name + ".XXXXXX" };
+    const int fd = ::mkstemp(path.data());
+    if (fd == -1) {
+        std::cerr << "Can not create temporary file\n";
+        std::exit(EXIT_FAILURE);
+    }
+    ::close(fd);
+    return path;
+}
+
+// Append data to f, visible to readers of its descriptor.
+inline void append(std::FILE * f, const std::string & data)
+{
+    std::fwrite(data.data(), 1, data.size(), f);
+    std::fflush(f);
+}
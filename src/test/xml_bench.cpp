@@ -0,0 +1,77 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "../libs/xml/XMLDocument.hpp"
+#include "../libs/xml/XMLNode.hpp"
+#include "../libs/xml/XMLparser.hpp"
+
+using ctguard::libs::xml::XMLDocument;
+using ctguard::libs::xml::XMLNode;
+using ctguard::libs::xml::XMLparser;
+
+// Parse throughput of the stream and the buffer based XML parser.
+int main(int argc, char ** argv)
+{
+    if (argc != 2 && argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " xml_file [iterations]\n";  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return EXIT_FAILURE;
+    }
+    const char * path = argv[1];                                     // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    const unsigned long iterations = argc == 3 ? std::stoul(argv[2]) : 1000;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic,google-runtime-int)
+
+    std::string content;
+    {
+        std::ifstream input{ path };
+        if (!input.is_open()) {
+            std::cerr << "Can not open '" << path << "': " << ::strerror(errno) << "\n";
+            return EXIT_FAILURE;
+        }
+        std::ostringstream oss;
+        oss << input.rdbuf();
+        content = oss.str();
+    }
+
+    const auto report = [&content, iterations](const char * name, std::chrono::steady_clock::duration d) {
+        const double seconds = std::chrono::duration<double>(d).count();
+        std::cout << name << ": " << iterations << " iterations in " << seconds << "s, "
+                  << (static_cast<double>(content.size()) * static_cast<double>(iterations) / seconds / 1024.0 / 1024.0) << " MiB/s\n";
+    };
+
+    try {
+        std::size_t nodes{ 0 };
+
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < iterations; ++i) {  // NOLINT(google-runtime-int)
+            std::istringstream iss{ content };
+            XMLparser parser{ iss };
+            const XMLNode root{ parser.parse() };
+            nodes += root.children().size();
+        }
+        report("stream parser", std::chrono::steady_clock::now() - start);
+
+        start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < iterations; ++i) {  // NOLINT(google-runtime-int)
+            const XMLDocument doc{ std::vector<char>{ content.begin(), content.end() } };
+            nodes += doc.root().children().size();
+        }
+        report("buffer parser", std::chrono::steady_clock::now() - start);
+
+        start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < iterations; ++i) {  // NOLINT(google-runtime-int)
+            const XMLDocument doc{ XMLDocument::load_file(path) };
+            nodes += doc.root().children().size();
+        }
+        report("buffer parser (incl. file read)", std::chrono::steady_clock::now() - start);
+
+        std::cout << "(" << nodes << " top level nodes)\n";
+
+    } catch (const std::exception & e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -2,39 +2,59 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <string_view>
 
+#include "../libs/xml/XMLDocument.hpp"
 #include "../libs/xml/XMLNode.hpp"
 #include "../libs/xml/XMLparser.hpp"
 
+using ctguard::libs::xml::XMLDocument;
 using ctguard::libs::xml::XMLNode;
 using ctguard::libs::xml::XMLparser;
 
 int main(int argc, char ** argv)
 {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " xml_file\n";  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    const std::string_view mode{ argc == 3 ? argv[1] : "--stream" };
+    if ((argc != 2 && argc != 3) || (mode != "--stream" && mode != "--buffer" && mode != "--compare")) {
+        std::cerr << "Usage: " << argv[0] << " [--stream|--buffer|--compare] xml_file\n";  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
         return EXIT_FAILURE;
     }
+    const char * path = argv[argc - 1];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
 
-    std::ifstream xml_input{ argv[1] };  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    std::ifstream xml_input{ path };
 
     if (!xml_input.is_open()) {
-        std::cerr << "Can not open '" << argv[1] << "': " << ::strerror(errno) << "\n";  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        std::cerr << "Can not open '" << path << "': " << ::strerror(errno) << "\n";
         return EXIT_FAILURE;
     }
 
     try {
-        XMLparser parser{ xml_input };
+        std::cout << "parsing " << path << "...";
 
-        std::cout << "parsing " << argv[1] << "...";  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        std::ostringstream stream_output;
+        if (mode != "--buffer") {
+            XMLparser parser{ xml_input };
+            XMLNode root{ parser.parse() };
+            stream_output << root;
+        }
 
-        XMLNode root{ parser.parse() };
+        std::ostringstream buffer_output;
+        if (mode != "--stream") {
+            const XMLDocument doc{ XMLDocument::load_file(path) };
+            buffer_output << doc.root();
+        }
 
         std::cout << " done\n";
 
+        if (mode == "--compare" && stream_output.str() != buffer_output.str()) {
+            std::cerr << "Error: stream and buffer parser results differ:\n" << stream_output.str() << "\n\n" << buffer_output.str() << "\n";
+            return EXIT_FAILURE;
+        }
+
         std::cout << "\nxml output:\n";
 
-        std::cout << root;
+        std::cout << (mode == "--buffer" ? buffer_output.str() : stream_output.str());
 
         std::cout << "\n\nFinished\n";
 